@@ -0,0 +1,41 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "print_bench.h"
+#include "export_bench.h"
+#include "lru_bench.h"
+#include "wheel_bench.h"
+#include "search_bench.h"
+#include "xor_bench.h"
+
+int main()
+{
+
+    bench_print_builtin_vs_sprintf();
+    bench_export_import_throughput();
+    bench_lru_vs_naive();
+    bench_wheel_vs_sorted_list();
+    bench_search_hotcold();
+    bench_xor_memory();
+    return 0;
+
+}
@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libll/ll.h>
+#include "bench.h"
+
+#define EXPORT_BENCH_RECORDS              200000
+#define EXPORT_BENCH_FEED_SIZE            65536
+
+typedef struct {
+    uint64_t id;
+    int32_t count;
+    double price;
+    char name[16];
+} bench_record_t;
+
+static const ll_field_t bench_fields[] = {
+    {"id", offsetof(bench_record_t, id), LL_FMT_U64, 0},
+    {"count", offsetof(bench_record_t, count), LL_FMT_I32, 0},
+    {"price", offsetof(bench_record_t, price), LL_FMT_DOUBLE, 0},
+    {"name", offsetof(bench_record_t, name), LL_FMT_STR, 16},
+};
+
+static const ll_schema_t bench_schema = {bench_fields, 4, sizeof(bench_record_t)};
+
+static ll_t*
+import_text(const char *text, size_t len, ll_format_t format, double *secs)
+{
+    double start = bench_now();
+    ll_import_t *imp = ll_import_begin(&bench_schema, format);
+    for(size_t off = 0; off < len; off += EXPORT_BENCH_FEED_SIZE)
+        ll_import_feed(imp, text + off, len - off < EXPORT_BENCH_FEED_SIZE ? len - off : EXPORT_BENCH_FEED_SIZE);
+    ll_t *ptr_list = ll_import_end(imp);
+    *secs = bench_now() - start;
+    return ptr_list;
+}
+
+static char*
+export_text(ll_t *ptr_list, ll_format_t format, size_t *len, double *secs)
+{
+    FILE *f = tmpfile();
+    double start = bench_now();
+    ssize_t written = ll_export(ptr_list, &bench_schema, format, fileno(f));
+    *secs = bench_now() - start;
+
+    *len = written > 0 ? (size_t)written : 0;
+    char *text = malloc(*len + 1);
+    lseek(fileno(f), 0, SEEK_SET);
+    if(read(fileno(f), text, *len) != (ssize_t)*len)
+        *len = 0;
+    fclose(f);
+    return text;
+}
+
+void
+bench_export_import_throughput()
+{
+    size_t cap = (size_t)EXPORT_BENCH_RECORDS * 64, len = 0;
+    char *csv = malloc(cap);
+    double secs;
+
+    len += sprintf(csv, "id,count,price,name\n");
+    for(size_t i = 0; i < EXPORT_BENCH_RECORDS; ++i)
+        len += sprintf(csv + len, "%zu,%d,%f,item-%zu\n", i * 7919, (int)(i % 1000) - 500, i * 0.25, i);
+
+    ll_t *ptr_list = import_text(csv, len, LL_CSV, &secs);
+    REPORT_MBS("ll_import csv", (double)len, secs);
+
+    size_t out_len;
+    char *out = export_text(ptr_list, LL_CSV, &out_len, &secs);
+    REPORT_MBS("ll_export csv", (double)out_len, secs);
+    free(out);
+
+    char *json = export_text(ptr_list, LL_JSON, &out_len, &secs);
+    REPORT_MBS("ll_export json", (double)out_len, secs);
+    ll_destroy(ptr_list);
+
+    ptr_list = import_text(json, out_len, LL_JSON, &secs);
+    REPORT_MBS("ll_import json", (double)out_len, secs);
+    ll_destroy(ptr_list);
+
+    free(json);
+    free(csv);
+}
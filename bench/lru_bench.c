@@ -0,0 +1,194 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/lru.h>
+#include "bench.h"
+
+#define LRU_BENCH_CAPACITY                100000
+#define LRU_BENCH_KEYS                    400000
+#define LRU_BENCH_OPS                     2000000
+
+/*
+ * Baseline shaped like std::unordered_map<key, std::list::iterator> plus
+ * std::list<std::pair<key, value>>: separately allocated list entries and
+ * separately allocated hash chain entries.
+ */
+typedef struct naive_entry_t {
+    struct naive_entry_t *prev, *next;
+    uint64_t key, value;
+} naive_entry_t;
+
+typedef struct naive_bucket_t {
+    struct naive_bucket_t *next;
+    uint64_t key;
+    naive_entry_t *entry;
+} naive_bucket_t;
+
+typedef struct {
+    naive_bucket_t **buckets;
+    size_t nbuckets, len, capacity;
+    naive_entry_t *head, *tail;
+} naive_lru_t;
+
+static size_t
+naive_hash(naive_lru_t *lru, uint64_t key)
+{
+    return (key * 0x9e3779b97f4a7c15ULL) % lru->nbuckets;
+}
+
+static void
+naive_unlink(naive_lru_t *lru, naive_entry_t *e)
+{
+    if(e->prev) e->prev->next = e->next; else lru->head = e->next;
+    if(e->next) e->next->prev = e->prev; else lru->tail = e->prev;
+}
+
+static void
+naive_push_front(naive_lru_t *lru, naive_entry_t *e)
+{
+    e->prev = NULL;
+    e->next = lru->head;
+    if(lru->head) lru->head->prev = e; else lru->tail = e;
+    lru->head = e;
+}
+
+static naive_bucket_t**
+naive_find(naive_lru_t *lru, uint64_t key)
+{
+    naive_bucket_t **b = &lru->buckets[naive_hash(lru, key)];
+    while(*b != NULL && (*b)->key != key)
+        b = &(*b)->next;
+    return b;
+}
+
+static uint64_t*
+naive_get(naive_lru_t *lru, uint64_t key)
+{
+    naive_bucket_t *b = *naive_find(lru, key);
+    if(b == NULL)
+        return NULL;
+    naive_unlink(lru, b->entry);
+    naive_push_front(lru, b->entry);
+    return &b->entry->value;
+}
+
+static void
+naive_put(naive_lru_t *lru, uint64_t key, uint64_t value)
+{
+    if(lru->len == lru->capacity)
+    {
+        naive_entry_t *victim = lru->tail;
+        naive_bucket_t **b = naive_find(lru, victim->key), *dead = *b;
+        *b = dead->next;
+        free(dead);
+        naive_unlink(lru, victim);
+        free(victim);
+        --lru->len;
+    }
+    naive_entry_t *e = malloc(sizeof(*e));
+    naive_bucket_t *b = malloc(sizeof(*b));
+    e->key = key;
+    e->value = value;
+    naive_push_front(lru, e);
+    b->key = key;
+    b->entry = e;
+    b->next = lru->buckets[naive_hash(lru, key)];
+    lru->buckets[naive_hash(lru, key)] = b;
+    ++lru->len;
+}
+
+static void
+naive_destroy(naive_lru_t *lru)
+{
+    for(size_t i = 0; i < lru->nbuckets; ++i)
+    {
+        naive_bucket_t *b = lru->buckets[i];
+        while(b != NULL)
+        {
+            naive_bucket_t *next = b->next;
+            free(b->entry);
+            free(b);
+            b = next;
+        }
+    }
+    free(lru->buckets);
+}
+
+void
+bench_lru_vs_naive()
+{
+    uint64_t *keys = malloc(sizeof(uint64_t) * LRU_BENCH_OPS);
+    uint64_t seed = 88172645463325252ULL, hits = 0, sum = 0;
+    double start;
+
+    /* Skewed key stream: most accesses fall on a quarter of the keys */
+    for(size_t i = 0; i < LRU_BENCH_OPS; ++i)
+    {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        uint64_t r = seed % LRU_BENCH_KEYS;
+        keys[i] = (seed >> 40) % 4 ? r / 4 : r;
+    }
+
+    ll_lru_t *lru = ll_lru_new(sizeof(uint64_t), sizeof(uint64_t), LRU_BENCH_CAPACITY, NULL, NULL);
+    start = bench_now();
+    for(size_t i = 0; i < LRU_BENCH_OPS; ++i)
+    {
+        uint64_t *value = (uint64_t*)ll_lru_get(lru, &keys[i]);
+        if(value != NULL)
+            sum += *value, ++hits;
+        else
+            ll_lru_put(lru, &keys[i], &keys[i]);
+    }
+    REPORT("ll_lru get/put", LRU_BENCH_OPS, bench_now() - start);
+
+    void **values = malloc(sizeof(void*) * LRU_BENCH_OPS);
+    start = bench_now();
+    hits += ll_lru_get_batch(lru, keys, LRU_BENCH_OPS, values);
+    REPORT("ll_lru_get_batch", LRU_BENCH_OPS, bench_now() - start);
+    free(values);
+    ll_lru_destroy(lru);
+
+    naive_lru_t naive = {0};
+    naive.nbuckets = LRU_BENCH_CAPACITY * 2;
+    naive.capacity = LRU_BENCH_CAPACITY;
+    naive.buckets = calloc(naive.nbuckets, sizeof(naive_bucket_t*));
+    start = bench_now();
+    for(size_t i = 0; i < LRU_BENCH_OPS; ++i)
+    {
+        uint64_t *value = naive_get(&naive, keys[i]);
+        if(value != NULL)
+            sum += *value, ++hits;
+        else
+            naive_put(&naive, keys[i], keys[i]);
+    }
+    REPORT("naive hash map + list get/put", LRU_BENCH_OPS, bench_now() - start);
+    naive_destroy(&naive);
+
+    if(hits == 0 && sum == 0)
+        printf("no hits\n");
+    free(keys);
+}
@@ -0,0 +1,115 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include "bench.h"
+
+#define PRINT_BENCH_ELEMENTS              20000
+#define PRINT_BENCH_ROUNDS                100
+
+int
+print_int_payload(void *ptr, char *str)
+{
+    return sprintf(str, "%d ", *((int32_t*)ptr));
+}
+
+int
+print_double_payload(void *ptr, char *str)
+{
+    return sprintf(str, "%f ", *((double*)ptr));
+}
+
+static ll_t*
+build_list(size_t size, void (*fill)(void*, size_t))
+{
+    char payload[16];
+    ll_t *ptr_list = NULL;
+
+    fill(payload, 0);
+    ptr_list = ll_init(payload, size);
+    for(size_t i = 1; i < PRINT_BENCH_ELEMENTS; ++i)
+    {
+        /* Inserting at the head skips the walk to the insertion point */
+        fill(payload, i);
+        ptr_list = ll_insert(ptr_list, payload, 0);
+    }
+    return ptr_list;
+}
+
+static void
+fill_int(void *dst, size_t i)
+{
+    int32_t v = (int32_t)(i * 2654435761u);
+    memcpy(dst, &v, sizeof(v));
+}
+
+static void
+fill_double(void *dst, size_t i)
+{
+    double v = (double)(int32_t)(i * 2654435761u) / 1024.0;
+    memcpy(dst, &v, sizeof(v));
+}
+
+static void
+run(const char *name, ll_t *ptr_list, ll_fmt_t fmt, int (*print)(void*, char*))
+{
+    double start, secs_cb, secs_fmt;
+    char *out;
+
+    start = bench_now();
+    for(int r = 0; r < PRINT_BENCH_ROUNDS; ++r)
+    {
+        out = ll_print(ptr_list, print);
+        free(out);
+    }
+    secs_cb = bench_now() - start;
+
+    start = bench_now();
+    for(int r = 0; r < PRINT_BENCH_ROUNDS; ++r)
+    {
+        out = ll_print_fmt(ptr_list, fmt);
+        free(out);
+    }
+    secs_fmt = bench_now() - start;
+
+    char label[64];
+    snprintf(label, sizeof(label), "ll_print %s sprintf", name);
+    REPORT(label, (double)PRINT_BENCH_ELEMENTS*PRINT_BENCH_ROUNDS, secs_cb);
+    snprintf(label, sizeof(label), "ll_print_fmt %s", name);
+    REPORT(label, (double)PRINT_BENCH_ELEMENTS*PRINT_BENCH_ROUNDS, secs_fmt);
+}
+
+void
+bench_print_builtin_vs_sprintf()
+{
+    ll_t *ptr_list = build_list(sizeof(int32_t), fill_int);
+    run("int32", ptr_list, LL_FMT_I32, print_int_payload);
+    ll_destroy(ptr_list);
+
+    ptr_list = build_list(sizeof(double), fill_double);
+    run("double", ptr_list, LL_FMT_DOUBLE, print_double_payload);
+    ll_destroy(ptr_list);
+}
@@ -0,0 +1,121 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <libll/ll.h>
+#include "bench.h"
+
+#define SEARCH_BENCH_ELEMENTS             32768
+#define SEARCH_BENCH_RECORD               128
+#define SEARCH_BENCH_QUERIES              200
+
+typedef struct {
+    uint64_t key;
+    char rest[SEARCH_BENCH_RECORD - sizeof(uint64_t)];
+} record_t;
+
+/* Counter of cache misses of this thread, -1 where perf events are not
+ * available, e.g. in containers */
+static int
+misses_open()
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void
+search_run(const char *name, unsigned int flags)
+{
+    ll_t *ptr_list = ll_new(sizeof(record_t), flags);
+    uint64_t seed = 88172645463325252ULL, misses = 0;
+    size_t found = 0, visited = 0;
+    record_t record;
+    ll_stats_t stats;
+    char label[64];
+
+    memset(&record, 0, sizeof(record));
+    for(size_t i = 0; i < SEARCH_BENCH_ELEMENTS; ++i)
+    {
+        /* Inserting at the head skips the walk to the insertion point */
+        record.key = i;
+        ll_insert(ptr_list, &record, 0);
+    }
+
+    int fd = misses_open();
+    if(fd >= 0)
+    {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    double start = bench_now();
+    for(size_t q = 0; q < SEARCH_BENCH_QUERIES; ++q)
+    {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        /* One query out of four misses and walks the whole list */
+        record.key = seed % (SEARCH_BENCH_ELEMENTS + SEARCH_BENCH_ELEMENTS/3);
+        found += ll_search(ptr_list, &record) != NULL;
+        visited += record.key < SEARCH_BENCH_ELEMENTS ?
+                   SEARCH_BENCH_ELEMENTS - record.key : SEARCH_BENCH_ELEMENTS;
+    }
+    double secs = bench_now() - start;
+    if(fd >= 0)
+    {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(fd, &misses, sizeof(misses)) != sizeof(misses))
+            misses = 0;
+        close(fd);
+    }
+
+    ll_stats(ptr_list, &stats);
+    snprintf(label, sizeof(label), "ll_search per node, %s", name);
+    REPORT(label, visited, secs);
+    if(fd >= 0)
+        printf("%-40s %12.3f misses/node (%zu found)\n", "", (double)misses / visited, found);
+    else
+        printf("%-40s %12s misses/node (%zu found)\n", "", "n/a", found);
+    if(flags & LL_HUGEPAGES)
+        printf("%-40s %12zu slabs, %zu MAP_HUGETLB, %zu THP\n", "",
+               stats.slabs, stats.hugetlb_slabs, stats.thp_slabs);
+    ll_destroy(ptr_list);
+}
+
+void
+bench_search_hotcold()
+{
+    search_run("pooled", LL_POOLED);
+    search_run("LL_HUGEPAGES", LL_HUGEPAGES);
+    search_run("LL_HOTCOLD", LL_HOTCOLD);
+}
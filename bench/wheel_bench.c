@@ -0,0 +1,108 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <libll/ll.h>
+#include <libll/wheel.h>
+#include "bench.h"
+
+#define WHEEL_BENCH_TIMERS                1000000
+#define WHEEL_BENCH_HORIZON               (1 << 22)
+
+/* The sorted list baseline is quadratic, it only gets a sample */
+#define WHEEL_BENCH_SORTED_TIMERS         20000
+
+typedef struct sorted_timer_t {
+    struct sorted_timer_t *prev, *next;
+    uint64_t expires;
+} sorted_timer_t;
+
+static void
+count_expired(void *data, void *ctx)
+{
+    *(uint64_t*)ctx += *(uint64_t*)data;
+}
+
+void
+bench_wheel_vs_sorted_list()
+{
+    uint64_t *expires = malloc(sizeof(uint64_t) * WHEEL_BENCH_TIMERS);
+    ll_node_t **timers = malloc(sizeof(ll_node_t*) * WHEEL_BENCH_TIMERS);
+    uint64_t seed = 88172645463325252ULL, sum = 0;
+    double start;
+
+    for(size_t i = 0; i < WHEEL_BENCH_TIMERS; ++i)
+    {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        expires[i] = 1 + seed % WHEEL_BENCH_HORIZON;
+    }
+
+    ll_wheel_t *wheel = ll_wheel_new(sizeof(uint64_t), 0);
+    start = bench_now();
+    for(size_t i = 0; i < WHEEL_BENCH_TIMERS; ++i)
+        timers[i] = ll_wheel_schedule(wheel, expires[i], &expires[i]);
+    REPORT("ll_wheel_schedule, 10^6 pending", WHEEL_BENCH_TIMERS, bench_now() - start);
+
+    start = bench_now();
+    for(size_t i = 0; i < WHEEL_BENCH_TIMERS; i += 2)
+        ll_wheel_cancel(wheel, timers[i]);
+    REPORT("ll_wheel_cancel", WHEEL_BENCH_TIMERS/2, bench_now() - start);
+
+    start = bench_now();
+    size_t fired = ll_wheel_advance(wheel, WHEEL_BENCH_HORIZON, count_expired, &sum);
+    REPORT("ll_wheel_advance, per fired timer", fired, bench_now() - start);
+    ll_wheel_destroy(wheel);
+
+    /* Baseline: insertion into a list kept sorted by expiry */
+    sorted_timer_t *head = NULL;
+    start = bench_now();
+    for(size_t i = 0; i < WHEEL_BENCH_SORTED_TIMERS; ++i)
+    {
+        sorted_timer_t *t = malloc(sizeof(*t)), **link = &head, *prev = NULL;
+        t->expires = expires[i];
+        while(*link != NULL && (*link)->expires <= t->expires)
+        {
+            prev = *link;
+            link = &(*link)->next;
+        }
+        t->prev = prev;
+        t->next = *link;
+        if(*link != NULL)
+            (*link)->prev = t;
+        *link = t;
+    }
+    REPORT("sorted list insert, 2*10^4 pending", WHEEL_BENCH_SORTED_TIMERS, bench_now() - start);
+    while(head != NULL)
+    {
+        sorted_timer_t *next = head->next;
+        sum += head->expires;
+        free(head);
+        head = next;
+    }
+
+    if(sum == 0)
+        printf("no timers\n");
+    free(timers);
+    free(expires);
+}
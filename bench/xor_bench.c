@@ -0,0 +1,96 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <libll/ll.h>
+#include <libll/xor.h>
+#include "bench.h"
+
+#define XOR_BENCH_ELEMENTS                32768
+#define XOR_BENCH_WALKS                   100
+
+/* Bytes handed out by malloc, slabs included */
+static size_t
+heap_used()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static void
+list_run(const char *name, unsigned int flags)
+{
+    size_t before = heap_used();
+    ll_t *ptr_list = ll_new(sizeof(uint64_t), flags);
+    uint64_t sum = 0;
+    char label[64];
+
+    for(uint64_t i = 0; i < XOR_BENCH_ELEMENTS; ++i)
+        ll_insert(ptr_list, &i, 0);
+    size_t bytes = heap_used() - before;
+
+    double start = bench_now();
+    for(size_t w = 0; w < XOR_BENCH_WALKS; ++w)
+        for(ll_node_t *ptr_node = ptr_list->root; ptr_node != NULL; ptr_node = ptr_node->next)
+            sum += *(uint64_t*)ll_node_payload(ptr_node);
+    double secs = bench_now() - start;
+
+    snprintf(label, sizeof(label), "walk per node, %s", name);
+    REPORT(label, (double)XOR_BENCH_ELEMENTS*XOR_BENCH_WALKS, secs);
+    printf("%-40s %12.1f bytes/element (sum %llu)\n", "", (double)bytes / XOR_BENCH_ELEMENTS,
+           (unsigned long long)sum);
+    ll_destroy(ptr_list);
+}
+
+static void
+xor_run()
+{
+    size_t before = heap_used();
+    ll_xor_t *ptr_list = ll_xor_new(sizeof(uint64_t));
+    uint64_t sum = 0;
+
+    for(uint64_t i = 0; i < XOR_BENCH_ELEMENTS; ++i)
+        ll_xor_push_back(ptr_list, &i);
+    size_t bytes = heap_used() - before;
+
+    double start = bench_now();
+    for(size_t w = 0; w < XOR_BENCH_WALKS; ++w)
+        for(ll_xor_iter_t it = ll_xor_begin(ptr_list); it.cur != NULL; it = ll_xor_next(it))
+            sum += *(uint64_t*)ll_xor_payload(it);
+    double secs = bench_now() - start;
+
+    REPORT("walk per node, ll_xor", (double)XOR_BENCH_ELEMENTS*XOR_BENCH_WALKS, secs);
+    printf("%-40s %12.1f bytes/element (sum %llu)\n", "", (double)bytes / XOR_BENCH_ELEMENTS,
+           (unsigned long long)sum);
+    ll_xor_destroy(ptr_list);
+}
+
+void
+bench_xor_memory()
+{
+    list_run("ll_t", 0);
+    list_run("ll_t LL_POOLED", LL_POOLED);
+    xor_run();
+}
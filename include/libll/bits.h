@@ -0,0 +1,45 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __BITS_H__
+#define __BITS_H__
+
+#include <sys/types.h>
+#include <libll/ll.h>
+
+/* List of unsigned integers of 1 to 16 bits, packed in chunks of 1024
+ * bytes instead of taking a node each */
+typedef struct ll_bits_t_internal ll_bits_t;
+
+ll_bits_t* ll_bits_new(unsigned int width);
+void ll_bits_destroy(ll_bits_t* ptr_bits);
+size_t ll_bits_len(ll_bits_t* ptr_bits);
+int ll_bits_get(ll_bits_t* ptr_bits, size_t pos);
+int ll_bits_set(ll_bits_t* ptr_bits, size_t pos, unsigned int value);
+int ll_bits_insert(ll_bits_t* ptr_bits, size_t pos, unsigned int value);
+int ll_bits_del(ll_bits_t* ptr_bits, size_t pos);
+size_t ll_bits_count(ll_bits_t* ptr_bits, unsigned int value);
+size_t ll_bits_rank(ll_bits_t* ptr_bits, unsigned int value, size_t pos);
+ssize_t ll_bits_select(ll_bits_t* ptr_bits, unsigned int value, size_t k);
+ssize_t ll_bits_search(ll_bits_t* ptr_bits, unsigned int value, size_t start);
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __ILIST_H__
+#define __ILIST_H__
+
+#include <libll/ll.h>
+
+typedef struct ll_ilist_t_internal ll_ilist_t;
+
+/* Half open range [start, end), at the beginning of every payload */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+} ll_range_t;
+
+ll_ilist_t* ll_ilist_new(void);
+void ll_ilist_destroy(ll_ilist_t* ptr_ilist);
+size_t ll_ilist_len(ll_ilist_t* ptr_ilist);
+int ll_ilist_add(ll_ilist_t* ptr_ilist, uint64_t start, uint64_t end);
+int ll_ilist_del(ll_ilist_t* ptr_ilist, uint64_t start, uint64_t end);
+ll_node_t* ll_ilist_find(ll_ilist_t* ptr_ilist, uint64_t point);
+ll_node_t* ll_ilist_first(ll_ilist_t* ptr_ilist, uint64_t start, uint64_t end);
+ll_t* ll_ilist_list(ll_ilist_t* ptr_ilist);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LHM_H__
+#define __LHM_H__
+
+#include <libll/ll.h>
+
+typedef struct ll_lhm_t_internal ll_lhm_t;
+
+ll_lhm_t* ll_lhm_new(size_t key_size, size_t value_size);
+void ll_lhm_destroy(ll_lhm_t* ptr_lhm);
+size_t ll_lhm_len(ll_lhm_t* ptr_lhm);
+void* ll_lhm_get(ll_lhm_t* ptr_lhm, const void* key);
+int ll_lhm_put(ll_lhm_t* ptr_lhm, const void* key, const void* value);
+int ll_lhm_del(ll_lhm_t* ptr_lhm, const void* key);
+void* ll_lhm_value(ll_lhm_t* ptr_lhm, ll_node_t* ptr_node);
+ll_t* ll_lhm_list(ll_lhm_t* ptr_lhm);
+
+#endif
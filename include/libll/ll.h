@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 typedef struct {
     void *payload;
@@ -37,18 +38,191 @@ typedef struct ll_node_t_internal {
     struct ll_node_t_internal *prev;
 } ll_node_t;
 
+typedef struct ll_pool_t_internal ll_pool_t;
+typedef struct ll_strtab_t_internal ll_strtab_t;
+
+/* The last node links back to the root, and the root to the last node */
+#define LL_CIRCULAR                       0x1
+/* Nodes are carved from slabs, which also enables handles */
+#define LL_POOLED                         0x2
+/* Pooled list keeping an order statistic index for O(log n) positional
+ * queries: ll_index_of, ll_node_get and ll_sample */
+#define LL_INDEXED                        0x4
+/* Indexed list also keeping its content hash up to date, for O(1) ll_hash */
+#define LL_HASHED                         0x8
+/* Each node carries its own payload length, with the bytes stored inline in
+ * the same allocation as the node. Not compatible with LL_POOLED. */
+#define LL_VARIABLE                       0x10
+/* Pooled list keeping nodes and a fingerprint of their payload in one pool
+ * and payloads in another, so that ll_search only walks densely packed
+ * nodes. Not compatible with LL_VARIABLE and LL_INDEXED. */
+#define LL_HOTCOLD                        0x20
+/* Pooled list whose slabs are 2 MB mappings backed by huge pages when the
+ * system provides them, see ll_stats */
+#define LL_HUGEPAGES                      0x40
+/* Pooled list whose slabs are placed on NUMA nodes, by default the node of
+ * the thread allocating nodes, see ll_numa_set_node and ll_numa_migrate */
+#define LL_NUMA                           0x80
+/* LL_VARIABLE list of strings. Nodes cache the hash of their string, which
+ * searches compare along with the length before the bytes, and the strings
+ * may be interned in a table shared among lists, see ll_set_strtab */
+#define LL_STRING                         0x100
+/* Payloads live in reference counted blocks which lists can share, see
+ * ll_insert_shared. Writes go through ll_node_payload_mut, which first
+ * copies payloads other nodes still use. */
+#define LL_SHARED                         0x200
+/* Deleted nodes are unlinked right away but freed later in batches, by
+ * ll_compact, called once enough of them pile up or explicitly */
+#define LL_LAZY                           0x400
+
+/* Payload alignment for ll_new_aligned which gives each payload cache lines
+ * of its own, against false sharing between threads */
+#define LL_CACHELINE                      64
+
 typedef struct {
     ll_node_t* root;
+    /* Number of linked nodes */
+    size_t len;
     size_t element_size;
+    ll_pool_t* pool;
+    unsigned int flags;
+    /* Node and position of the last ll_index_of on unindexed lists */
+    ll_node_t* finger;
+    size_t finger_pos;
+    /* Root of the order statistic index of LL_INDEXED lists */
+    void* index;
+    /* Pool of the payloads of LL_HOTCOLD lists */
+    ll_pool_t* cold;
+    /* Alignment of payloads set by ll_new_aligned, 0 for the default */
+    size_t align;
+    /* Table interning the strings of LL_STRING lists */
+    ll_strtab_t* strtab;
+    /* Nodes deleted from LL_LAZY lists and not freed yet, linked by next */
+    ll_node_t* tombs;
+    size_t ntombs;
 } ll_t;
 
+/* Reference to a node of a pooled list which can be checked in O(1) for
+ * staleness, unlike a node pointer */
+typedef struct {
+    uint32_t index;
+    uint32_t generation;
+} ll_handle_t;
+
+/* Memory taken by the slabs of a pooled list, reported by ll_stats */
+typedef struct {
+    size_t slabs;
+    size_t bytes;
+    /* Live nodes carved from the slabs */
+    size_t objects;
+    /* LL_HUGEPAGES slabs backed by reserved huge pages (MAP_HUGETLB), and
+     * slabs advised for transparent huge pages, which the kernel may still
+     * back with small pages */
+    size_t hugetlb_slabs;
+    size_t thp_slabs;
+} ll_stats_t;
+
+/* Edits reported by ll_diff */
+typedef enum {
+    LL_DIFF_DEL,
+    LL_DIFF_INS
+} ll_edit_t;
+
+/* Called for each edit, pos being the position of node in its own list */
+typedef void (*ll_diff_cb_t)(ll_edit_t edit, size_t pos, ll_node_t *node, void *ctx);
+
+/* Source of uniformly distributed 64 bit random numbers */
+typedef uint64_t (*ll_rng_t)(void *ctx);
+
+/* Payload types understood by the built-in printers */
+typedef enum {
+    LL_FMT_U8,
+    LL_FMT_I8,
+    LL_FMT_U16,
+    LL_FMT_I16,
+    LL_FMT_U32,
+    LL_FMT_I32,
+    LL_FMT_U64,
+    LL_FMT_I64,
+    LL_FMT_FLOAT,
+    LL_FMT_DOUBLE,
+    LL_FMT_HEX,
+    LL_FMT_STR
+} ll_fmt_t;
+
+typedef enum {
+    LL_CSV,
+    LL_JSON
+} ll_format_t;
+
+/* Field of a fixed-layout record. size is only used by LL_FMT_STR, the
+ * length of the char array, and by LL_FMT_HEX, the number of bytes. */
+typedef struct {
+    const char* name;
+    size_t offset;
+    ll_fmt_t type;
+    size_t size;
+} ll_field_t;
+
+typedef struct {
+    const ll_field_t* fields;
+    size_t nfields;
+    size_t record_size;
+} ll_schema_t;
+
+typedef struct ll_import_t_internal ll_import_t;
+
 ll_t* ll_init(void *payload, size_t size);
+ll_t* ll_new(size_t size, unsigned int flags);
+ll_t* ll_new_aligned(size_t size, unsigned int flags, size_t align);
 void ll_destroy(ll_t* ptr_list);
+int ll_stats(ll_t* ptr_list, ll_stats_t* stats);
+int ll_numa_set_node(ll_t* ptr_list, int node);
+int ll_numa_migrate(ll_t* ptr_list, int node);
+int ll_numa_node_of(ll_node_t* ptr_node);
 char* ll_print(ll_t* ptr_list, int(print)(void*, char *));
+char* ll_print_fmt(ll_t* ptr_list, ll_fmt_t fmt);
+char* ll_print_mt(ll_t* ptr_list, int(print)(void*, char *), unsigned int nthreads);
+char* ll_print_fmt_mt(ll_t* ptr_list, ll_fmt_t fmt, unsigned int nthreads);
 size_t ll_len(ll_t* ptr_list);
 ll_t* ll_insert(ll_t* ptr_list, void *payload, size_t pos);
+ll_t* ll_insert_var(ll_t* ptr_list, const void *payload, size_t len, size_t pos);
 ll_node_t* ll_node_get(ll_t* ptr_list, size_t pos);
 void* ll_node_payload(ll_node_t* ptr_node);
+void* ll_node_payload_mut(ll_t* ptr_list, ll_node_t* ptr_node);
+ll_t* ll_insert_shared(ll_t* ptr_list, void* payload, size_t pos);
+size_t ll_payload_refs(ll_t* ptr_list, ll_node_t* ptr_node);
 ll_t* ll_del(ll_t* ptr_list, void* payload);
+int ll_del_node(ll_t* ptr_list, ll_node_t* ptr_node);
+int ll_del_handle(ll_t* ptr_list, ll_handle_t handle);
+size_t ll_compact(ll_t* ptr_list);
 ll_node_t* ll_search(ll_t* ptr_list, void* payload);
+ll_node_t* ll_search_var(ll_t* ptr_list, const void* payload, size_t len);
+size_t ll_node_size(ll_t* ptr_list, ll_node_t* ptr_node);
+ll_t* ll_insert_str(ll_t* ptr_list, const char* str, size_t pos);
+ll_node_t* ll_search_str(ll_t* ptr_list, const char* str);
+ll_strtab_t* ll_strtab_new(void);
+void ll_strtab_destroy(ll_strtab_t* ptr_strtab);
+size_t ll_strtab_len(ll_strtab_t* ptr_strtab);
+int ll_set_strtab(ll_t* ptr_list, ll_strtab_t* ptr_strtab);
+ll_node_t* ll_node_next(ll_node_t* ptr_node);
+ll_node_t* ll_node_prev(ll_node_t* ptr_node);
+int ll_set_circular(ll_t* ptr_list, int circular);
+int ll_rotate(ll_t* ptr_list, long k);
+ll_node_t* ll_rr_next(ll_t* ptr_list);
+ll_handle_t ll_handle(ll_t* ptr_list, ll_node_t* ptr_node);
+ll_node_t* ll_handle_node(ll_t* ptr_list, ll_handle_t handle);
+ssize_t ll_index_of(ll_t* ptr_list, ll_node_t* ptr_node);
+size_t ll_sample(ll_t* ptr_list, ll_node_t** nodes, size_t k, ll_rng_t rng, void* ctx);
+int ll_shuffle(ll_t* ptr_list, ll_rng_t rng, void* ctx);
+int ll_equal(ll_t* ptr_a, ll_t* ptr_b);
+uint64_t ll_hash(ll_t* ptr_list);
+void ll_node_changed(ll_t* ptr_list, ll_node_t* ptr_node);
+ssize_t ll_diff(ll_t* ptr_a, ll_t* ptr_b, ll_diff_cb_t cb, void* ctx);
+ssize_t ll_writev(ll_t* ptr_list, int fd, const void* sep, size_t sep_len);
+ssize_t ll_export(ll_t* ptr_list, const ll_schema_t* schema, ll_format_t format, int fd);
+ll_import_t* ll_import_begin(const ll_schema_t* schema, ll_format_t format);
+int ll_import_feed(ll_import_t* ptr_import, const char* buff, size_t len);
+ll_t* ll_import_end(ll_import_t* ptr_import);
+ll_t* ll_import_fd(int fd, const ll_schema_t* schema, ll_format_t format);
 #endif
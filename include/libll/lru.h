@@ -0,0 +1,44 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LRU_H__
+#define __LRU_H__
+
+#include <libll/ll.h>
+
+typedef struct ll_lru_t_internal ll_lru_t;
+
+/* Called with the key and value of every entry evicted to make room */
+typedef void (*ll_lru_evict_t)(void *key, void *value, void *ctx);
+
+ll_lru_t* ll_lru_new(size_t key_size, size_t value_size, size_t capacity, ll_lru_evict_t evict, void *ctx);
+void ll_lru_destroy(ll_lru_t* ptr_lru);
+size_t ll_lru_len(ll_lru_t* ptr_lru);
+void* ll_lru_get(ll_lru_t* ptr_lru, const void* key);
+size_t ll_lru_get_batch(ll_lru_t* ptr_lru, const void* keys, size_t n, void** values);
+int ll_lru_put(ll_lru_t* ptr_lru, const void* key, const void* value);
+int ll_lru_del(ll_lru_t* ptr_lru, const void* key);
+ll_node_t* ll_lru_node(ll_lru_t* ptr_lru, const void* key);
+void ll_lru_touch(ll_lru_t* ptr_lru, ll_node_t* ptr_node);
+ll_t* ll_lru_list(ll_lru_t* ptr_lru);
+
+#endif
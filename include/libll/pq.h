@@ -0,0 +1,43 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __PQ_H__
+#define __PQ_H__
+
+#include <libll/ll.h>
+
+typedef struct ll_pq_t_internal ll_pq_t;
+
+/* Orders payloads, negative when a has higher priority than b */
+typedef int (*ll_pq_cmp_t)(const void *a, const void *b);
+
+ll_pq_t* ll_pq_new(size_t size, ll_pq_cmp_t cmp);
+void ll_pq_destroy(ll_pq_t* ptr_pq);
+size_t ll_pq_len(ll_pq_t* ptr_pq);
+ll_node_t* ll_pq_push(ll_pq_t* ptr_pq, const void* payload);
+ll_node_t* ll_pq_peek(ll_pq_t* ptr_pq);
+int ll_pq_pop(ll_pq_t* ptr_pq, void* payload);
+int ll_pq_decrease(ll_pq_t* ptr_pq, ll_node_t* ptr_node, const void* payload);
+int ll_pq_del(ll_pq_t* ptr_pq, ll_node_t* ptr_node);
+int ll_pq_meld(ll_pq_t* ptr_pq, ll_pq_t* ptr_other);
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __WHEEL_H__
+#define __WHEEL_H__
+
+#include <libll/ll.h>
+
+typedef struct ll_wheel_t_internal ll_wheel_t;
+
+/* Called with the data of every timer which expires */
+typedef void (*ll_wheel_expire_t)(void *data, void *ctx);
+
+ll_wheel_t* ll_wheel_new(size_t data_size, uint64_t now);
+void ll_wheel_destroy(ll_wheel_t* ptr_wheel);
+size_t ll_wheel_len(ll_wheel_t* ptr_wheel);
+ll_node_t* ll_wheel_schedule(ll_wheel_t* ptr_wheel, uint64_t expires, const void* data);
+int ll_wheel_cancel(ll_wheel_t* ptr_wheel, ll_node_t* ptr_timer);
+size_t ll_wheel_advance(ll_wheel_t* ptr_wheel, uint64_t now, ll_wheel_expire_t expire, void* ctx);
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __XOR_H__
+#define __XOR_H__
+
+#include <libll/ll.h>
+
+/* Doubly linked list keeping a single link per node, the XOR of the
+ * addresses of its neighbours. A node alone cannot tell where its
+ * neighbours are, so there are no ll_node_t handles: positions are
+ * iterators holding two adjacent nodes, see the README for the calls
+ * available. */
+typedef struct ll_xor_t_internal ll_xor_t;
+typedef struct ll_xor_node_t_internal ll_xor_node_t;
+
+/* Position of cur, prev being the node before it. cur is NULL past the
+ * back, prev is NULL at the front. */
+typedef struct {
+    ll_xor_node_t* prev;
+    ll_xor_node_t* cur;
+} ll_xor_iter_t;
+
+ll_xor_t* ll_xor_new(size_t size);
+void ll_xor_destroy(ll_xor_t* ptr_list);
+size_t ll_xor_len(ll_xor_t* ptr_list);
+int ll_xor_push_front(ll_xor_t* ptr_list, const void* payload);
+int ll_xor_push_back(ll_xor_t* ptr_list, const void* payload);
+int ll_xor_pop_front(ll_xor_t* ptr_list, void* payload);
+int ll_xor_pop_back(ll_xor_t* ptr_list, void* payload);
+ll_xor_iter_t ll_xor_begin(ll_xor_t* ptr_list);
+ll_xor_iter_t ll_xor_end(ll_xor_t* ptr_list);
+ll_xor_iter_t ll_xor_next(ll_xor_iter_t it);
+ll_xor_iter_t ll_xor_prev(ll_xor_iter_t it);
+void* ll_xor_payload(ll_xor_iter_t it);
+ll_xor_iter_t ll_xor_search(ll_xor_t* ptr_list, const void* payload);
+int ll_xor_insert(ll_xor_t* ptr_list, ll_xor_iter_t* it, const void* payload);
+int ll_xor_erase(ll_xor_t* ptr_list, ll_xor_iter_t* it);
+int ll_xor_stats(ll_xor_t* ptr_list, ll_stats_t* stats);
+
+#endif
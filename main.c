@@ -1,5 +1,9 @@
+#include <time.h>
+#include <string.h>
 #include "ll.h"
 
+#define BENCH_ELEMENTS 1000000
+
 
 int
 print(void *ptr, char *str)
@@ -7,6 +11,42 @@ print(void *ptr, char *str)
     return sprintf(str,"%d ", *((uint8_t*)ptr));
 }
 
+static double
+now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/* Prints a long list with the sprintf callback and with the built-in
+ * printer, which give the same output */
+static void
+bench_print()
+{
+    ll_t* list = ll_new(sizeof(uint8_t), 0);
+    for(size_t i = 0; i < BENCH_ELEMENTS; ++i)
+    {
+        uint8_t value = (uint8_t)(i * 7);
+        ll_insert(list, &value, 0);
+    }
+
+    double start = now();
+    char *by_callback = ll_print(list, print);
+    double callback = now() - start;
+    start = now();
+    char *by_fmt = ll_print_fmt(list, LL_FMT_U8);
+    double fmt = now() - start;
+
+    printf("ll_print with sprintf callback: %8.1f ns/element\n", callback*1e9/BENCH_ELEMENTS);
+    printf("ll_print_fmt LL_FMT_U8:         %8.1f ns/element\n", fmt*1e9/BENCH_ELEMENTS);
+    if(by_callback == NULL || by_fmt == NULL || strcmp(by_callback, by_fmt) != 0)
+        printf("outputs differ\n");
+    free(by_callback);
+    free(by_fmt);
+    ll_destroy(list);
+}
+
 int
 main() {
     int v[] = {20, 30};
@@ -14,5 +54,5 @@ main() {
     list_int = ll_init(&v[0], sizeof(int));
     list_int = ll_insert(list_int, &v[1], ll_len(list_int));
     printf("%s\n", ll_print(list_int, print));
+    bench_print();
 }
-
@@ -0,0 +1,476 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/bits.h>
+#include "ll_internal.h"
+
+/* Words of a chunk. Values never straddle two words, which wastes
+ * 64 % width bits per word but keeps every word a vector of lanes. */
+#define LLIST_BITS_WORDS                  128
+
+typedef struct {
+    size_t len;
+    uint64_t words[LLIST_BITS_WORDS];
+} _ll_bits_chunk_t;
+
+struct ll_bits_t_internal {
+    /* Unrolled list of chunks */
+    ll_t *chunks;
+    size_t len;
+    unsigned int width;
+    size_t per_word;
+    size_t per_chunk;
+    /* Mask of a value, of the lanes of a word, and of the lowest and
+     * highest bit of every lane */
+    uint64_t value_mask;
+    uint64_t lanes;
+    uint64_t low;
+    uint64_t high;
+};
+
+
+static inline uint64_t
+_ll_bits_below(size_t nbits)
+{
+    return nbits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << nbits) - 1;
+}
+
+
+static inline _ll_bits_chunk_t*
+_ll_bits_chunk(ll_node_t *ptr_node)
+{
+    return (_ll_bits_chunk_t*)_ll_node_payload(ptr_node);
+}
+
+
+/**
+ * @brief Creates an empty list of width bit values
+ *
+ * Each chunk holds 1024 bytes of values and a node of a pooled list links
+ * the chunks, so for small widths the overhead per element is a fraction
+ * of a bit rather than a node.
+ * @param width Bits per value, 1 to 16
+ * @return Pointer to the list, NULL upon failure
+ */
+ll_bits_t*
+ll_bits_new(unsigned int width)
+{
+    if(width < 1 || width > 16)
+        return NULL;
+    ll_bits_t *ptr_bits = (ll_bits_t*)calloc(1, sizeof(ll_bits_t));
+    if(ptr_bits == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    ptr_bits->width = width;
+    ptr_bits->per_word = 64 / width;
+    ptr_bits->per_chunk = ptr_bits->per_word * LLIST_BITS_WORDS;
+    ptr_bits->value_mask = _ll_bits_below(width);
+    ptr_bits->lanes = _ll_bits_below(ptr_bits->per_word * width);
+    for(size_t l = 0; l < ptr_bits->per_word; ++l)
+        ptr_bits->low |= (uint64_t)1 << (l * width);
+    ptr_bits->high = ptr_bits->low << (width - 1);
+    ptr_bits->chunks = _ll_new(sizeof(_ll_bits_chunk_t), LL_POOLED);
+    if(ptr_bits->chunks == NULL)
+    {
+        free(ptr_bits);
+        return NULL;
+    }
+    return ptr_bits;
+}
+
+
+void
+ll_bits_destroy(ll_bits_t *ptr_bits)
+{
+    if(ptr_bits == NULL)
+        return;
+    ll_destroy(ptr_bits->chunks);
+    free(ptr_bits);
+}
+
+
+size_t
+ll_bits_len(ll_bits_t *ptr_bits)
+{
+    return ptr_bits != NULL ? ptr_bits->len : 0;
+}
+
+
+/**
+ * @brief Finds the chunk holding a position
+ * @param pos Position in the list, replaced by the position in the chunk
+ * @param append Whether pos may be the length of the list, in which case
+ * the last chunk is returned
+ * @return The chunk node, NULL if pos is out of range or there are no chunks
+ */
+static ll_node_t*
+_ll_bits_find(ll_bits_t *ptr_bits, size_t *pos, int append)
+{
+    ll_node_t *ptr_node = ptr_bits->chunks->root;
+    while(ptr_node != NULL)
+    {
+        size_t len = _ll_bits_chunk(ptr_node)->len;
+        if(*pos < len || (append && *pos == len && ptr_node->next == NULL))
+            return ptr_node;
+        *pos -= len;
+        ptr_node = ptr_node->next;
+    }
+    return NULL;
+}
+
+
+static inline unsigned int
+_ll_bits_lane(ll_bits_t *ptr_bits, _ll_bits_chunk_t *chunk, size_t off)
+{
+    size_t shift = (off % ptr_bits->per_word) * ptr_bits->width;
+    return (unsigned int)((chunk->words[off / ptr_bits->per_word] >> shift) & ptr_bits->value_mask);
+}
+
+
+static inline void
+_ll_bits_set_lane(ll_bits_t *ptr_bits, _ll_bits_chunk_t *chunk, size_t off, unsigned int value)
+{
+    size_t shift = (off % ptr_bits->per_word) * ptr_bits->width;
+    uint64_t *word = &chunk->words[off / ptr_bits->per_word];
+    *word = (*word & ~(ptr_bits->value_mask << shift)) | ((uint64_t)value << shift);
+}
+
+
+/**
+ * @brief Compares all the lanes of a word with a value at once
+ *
+ * Adding 2^(width-1) - 1 to the low bits of each lane carries into its
+ * high bit unless they are all zero, and no carry crosses into the next
+ * lane, so the lanes of word ^ pattern which stay zero are the matches.
+ * @param pattern The value repeated in every lane
+ * @return The highest bit of every matching lane
+ */
+static inline uint64_t
+_ll_bits_match(ll_bits_t *ptr_bits, uint64_t word, uint64_t pattern)
+{
+    uint64_t x = word ^ pattern;
+    uint64_t y = (x & ~ptr_bits->high) + (ptr_bits->lanes & ~ptr_bits->high);
+    return ~(x | y) & ptr_bits->high;
+}
+
+
+/**
+ * @brief Returns the highest bit of the lanes of word w of a chunk which
+ * are in use
+ */
+static inline uint64_t
+_ll_bits_used(ll_bits_t *ptr_bits, _ll_bits_chunk_t *chunk, size_t w)
+{
+    size_t start = w * ptr_bits->per_word;
+    if(start >= chunk->len)
+        return 0;
+    if(chunk->len - start >= ptr_bits->per_word)
+        return ptr_bits->high;
+    return ptr_bits->high & _ll_bits_below((chunk->len - start) * ptr_bits->width);
+}
+
+
+/**
+ * @brief Counts the values of a chunk equal to value before position end
+ */
+static size_t
+_ll_bits_count_chunk(ll_bits_t *ptr_bits, _ll_bits_chunk_t *chunk, uint64_t pattern, size_t end)
+{
+    size_t count = 0;
+    size_t nwords = (end + ptr_bits->per_word - 1) / ptr_bits->per_word;
+    for(size_t w = 0; w < nwords; ++w)
+    {
+        uint64_t used = _ll_bits_used(ptr_bits, chunk, w);
+        if(end - w * ptr_bits->per_word < ptr_bits->per_word)
+            used &= _ll_bits_below((end - w * ptr_bits->per_word) * ptr_bits->width);
+        count += __builtin_popcountll(_ll_bits_match(ptr_bits, chunk->words[w], pattern) & used);
+    }
+    return count;
+}
+
+
+/**
+ * @brief Shifts the values from off on up by one lane. The chunk must not
+ * be full.
+ */
+static void
+_ll_bits_shift_up(ll_bits_t *ptr_bits, _ll_bits_chunk_t *chunk, size_t off)
+{
+    size_t first = off / ptr_bits->per_word;
+    size_t top = (ptr_bits->per_word - 1) * ptr_bits->width;
+
+    for(size_t w = chunk->len / ptr_bits->per_word; w > first; --w)
+        chunk->words[w] = ((chunk->words[w] << ptr_bits->width) | (chunk->words[w-1] >> top)) &
+                          ptr_bits->lanes;
+    uint64_t below = chunk->words[first] & _ll_bits_below((off % ptr_bits->per_word) * ptr_bits->width);
+    chunk->words[first] = (below | ((chunk->words[first] & ~below) << ptr_bits->width)) & ptr_bits->lanes;
+}
+
+
+/**
+ * @brief Shifts the values after off down by one lane, overwriting off
+ */
+static void
+_ll_bits_shift_down(ll_bits_t *ptr_bits, _ll_bits_chunk_t *chunk, size_t off)
+{
+    size_t first = off / ptr_bits->per_word;
+    size_t last = (chunk->len - 1) / ptr_bits->per_word;
+    size_t top = (ptr_bits->per_word - 1) * ptr_bits->width;
+    uint64_t mask = _ll_bits_below((off % ptr_bits->per_word) * ptr_bits->width);
+
+    chunk->words[first] = (chunk->words[first] & mask) | ((chunk->words[first] >> ptr_bits->width) & ~mask);
+    for(size_t w = first; w < last; ++w)
+    {
+        chunk->words[w] |= (chunk->words[w+1] & ptr_bits->value_mask) << top;
+        chunk->words[w+1] >>= ptr_bits->width;
+    }
+}
+
+
+/**
+ * @brief Returns the value at a position, -1 if out of range
+ */
+int
+ll_bits_get(ll_bits_t *ptr_bits, size_t pos)
+{
+    if(ptr_bits == NULL)
+        return -1;
+    ll_node_t *ptr_node = _ll_bits_find(ptr_bits, &pos, 0);
+    if(ptr_node == NULL)
+        return -1;
+    return (int)_ll_bits_lane(ptr_bits, _ll_bits_chunk(ptr_node), pos);
+}
+
+
+/**
+ * @brief Overwrites the value at a position
+ * @return 0 on success, -1 if pos is out of range or value does not fit
+ */
+int
+ll_bits_set(ll_bits_t *ptr_bits, size_t pos, unsigned int value)
+{
+    if(ptr_bits == NULL || value > ptr_bits->value_mask)
+        return -1;
+    ll_node_t *ptr_node = _ll_bits_find(ptr_bits, &pos, 0);
+    if(ptr_node == NULL)
+        return -1;
+    _ll_bits_set_lane(ptr_bits, _ll_bits_chunk(ptr_node), pos, value);
+    return 0;
+}
+
+
+/**
+ * @brief Inserts a value so that it ends up at position pos, splitting the
+ * chunk which receives it in two halves when it is full
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_bits_insert(ll_bits_t *ptr_bits, size_t pos, unsigned int value)
+{
+    if(ptr_bits == NULL || value > ptr_bits->value_mask || pos > ptr_bits->len)
+        return -1;
+    ll_node_t *ptr_node = _ll_bits_find(ptr_bits, &pos, 1);
+    if(ptr_node == NULL)
+    {
+        ptr_node = _ll_node_new(ptr_bits->chunks, NULL);
+        if(ptr_node == NULL)
+            return -1;
+        memset(_ll_bits_chunk(ptr_node), 0, sizeof(_ll_bits_chunk_t));
+        _ll_link_after(ptr_bits->chunks, NULL, ptr_node);
+    }
+
+    _ll_bits_chunk_t *chunk = _ll_bits_chunk(ptr_node);
+    if(chunk->len == ptr_bits->per_chunk)
+    {
+        ll_node_t *ptr_half = _ll_node_new(ptr_bits->chunks, NULL);
+        if(ptr_half == NULL)
+            return -1;
+        _ll_bits_chunk_t *half = _ll_bits_chunk(ptr_half);
+        size_t words = LLIST_BITS_WORDS / 2;
+        memcpy(half->words, chunk->words + words, words * sizeof(uint64_t));
+        memset(half->words + words, 0, words * sizeof(uint64_t));
+        memset(chunk->words + words, 0, words * sizeof(uint64_t));
+        chunk->len = words * ptr_bits->per_word;
+        half->len = ptr_bits->per_chunk - chunk->len;
+        _ll_link_after(ptr_bits->chunks, ptr_node, ptr_half);
+        if(pos > chunk->len)
+        {
+            pos -= chunk->len;
+            chunk = half;
+        }
+    }
+
+    _ll_bits_shift_up(ptr_bits, chunk, pos);
+    _ll_bits_set_lane(ptr_bits, chunk, pos, value);
+    ++chunk->len;
+    ++ptr_bits->len;
+    return 0;
+}
+
+
+/**
+ * @brief Removes the value at a position. Chunks which become empty are
+ * freed, and a chunk is merged with the next one when both fit in half a
+ * chunk.
+ * @return 0 on success, -1 if pos is out of range
+ */
+int
+ll_bits_del(ll_bits_t *ptr_bits, size_t pos)
+{
+    if(ptr_bits == NULL)
+        return -1;
+    ll_node_t *ptr_node = _ll_bits_find(ptr_bits, &pos, 0);
+    if(ptr_node == NULL)
+        return -1;
+    _ll_bits_chunk_t *chunk = _ll_bits_chunk(ptr_node);
+    _ll_bits_shift_down(ptr_bits, chunk, pos);
+    --chunk->len;
+    --ptr_bits->len;
+
+    if(chunk->len == 0)
+    {
+        _ll_unlink(ptr_bits->chunks, ptr_node);
+        _ll_free_node(ptr_bits->chunks, ptr_node);
+        return 0;
+    }
+    ll_node_t *ptr_next = ptr_node->next;
+    if(ptr_next != NULL && chunk->len + _ll_bits_chunk(ptr_next)->len <= ptr_bits->per_chunk / 2)
+    {
+        _ll_bits_chunk_t *next = _ll_bits_chunk(ptr_next);
+        for(size_t off = 0; off < next->len; ++off)
+            _ll_bits_set_lane(ptr_bits, chunk, chunk->len++, _ll_bits_lane(ptr_bits, next, off));
+        _ll_unlink(ptr_bits->chunks, ptr_next);
+        _ll_free_node(ptr_bits->chunks, ptr_next);
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Returns how many values before position pos equal value, pos
+ * being clamped to the length of the list
+ *
+ * Whole words of values are compared at once and the matches counted with
+ * popcount.
+ */
+size_t
+ll_bits_rank(ll_bits_t *ptr_bits, unsigned int value, size_t pos)
+{
+    size_t rank = 0;
+    if(ptr_bits == NULL || value > ptr_bits->value_mask)
+        return 0;
+    uint64_t pattern = value * ptr_bits->low;
+    for(ll_node_t *ptr_node = ptr_bits->chunks->root; ptr_node != NULL && pos > 0; ptr_node = ptr_node->next)
+    {
+        _ll_bits_chunk_t *chunk = _ll_bits_chunk(ptr_node);
+        size_t end = pos < chunk->len ? pos : chunk->len;
+        rank += _ll_bits_count_chunk(ptr_bits, chunk, pattern, end);
+        pos -= end;
+    }
+    return rank;
+}
+
+
+/**
+ * @brief Returns how many values equal value
+ */
+size_t
+ll_bits_count(ll_bits_t *ptr_bits, unsigned int value)
+{
+    return ll_bits_rank(ptr_bits, value, ll_bits_len(ptr_bits));
+}
+
+
+/**
+ * @brief Returns the position of the k-th value equal to value, k
+ * starting from 0, -1 if there are k values or less
+ */
+ssize_t
+ll_bits_select(ll_bits_t *ptr_bits, unsigned int value, size_t k)
+{
+    size_t base = 0;
+    if(ptr_bits == NULL || value > ptr_bits->value_mask)
+        return -1;
+    uint64_t pattern = value * ptr_bits->low;
+    for(ll_node_t *ptr_node = ptr_bits->chunks->root; ptr_node != NULL; ptr_node = ptr_node->next)
+    {
+        _ll_bits_chunk_t *chunk = _ll_bits_chunk(ptr_node);
+        for(size_t w = 0; w * ptr_bits->per_word < chunk->len; ++w)
+        {
+            uint64_t match = _ll_bits_match(ptr_bits, chunk->words[w], pattern) &
+                             _ll_bits_used(ptr_bits, chunk, w);
+            size_t count = __builtin_popcountll(match);
+            if(k >= count)
+            {
+                k -= count;
+                continue;
+            }
+            while(k-- > 0)
+                match &= match - 1;
+            return base + w * ptr_bits->per_word + __builtin_ctzll(match) / ptr_bits->width;
+        }
+        base += chunk->len;
+    }
+    return -1;
+}
+
+
+/**
+ * @brief Returns the position of the first value equal to value from
+ * position start on, -1 if there is none
+ *
+ * Each word is compared as a vector of lanes, see _ll_bits_match.
+ */
+ssize_t
+ll_bits_search(ll_bits_t *ptr_bits, unsigned int value, size_t start)
+{
+    if(ptr_bits == NULL || value > ptr_bits->value_mask || start >= ptr_bits->len)
+        return -1;
+    size_t off = start;
+    size_t base = start;
+    ll_node_t *ptr_node = _ll_bits_find(ptr_bits, &off, 0);
+    uint64_t pattern = value * ptr_bits->low;
+
+    base -= off;
+    /* Lanes before start are masked out of the first word only */
+    size_t w = off / ptr_bits->per_word;
+    uint64_t skip = ~_ll_bits_below((off % ptr_bits->per_word) * ptr_bits->width);
+    for(; ptr_node != NULL; ptr_node = ptr_node->next, w = 0)
+    {
+        _ll_bits_chunk_t *chunk = _ll_bits_chunk(ptr_node);
+        for(; w * ptr_bits->per_word < chunk->len; ++w)
+        {
+            uint64_t match = _ll_bits_match(ptr_bits, chunk->words[w], pattern) &
+                             _ll_bits_used(ptr_bits, chunk, w) & skip;
+            skip = ~(uint64_t)0;
+            if(match != 0)
+                return base + w * ptr_bits->per_word + __builtin_ctzll(match) / ptr_bits->width;
+        }
+        base += chunk->len;
+    }
+    return -1;
+}
@@ -0,0 +1,317 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+/* Whether the index of a list holds its content hash in list order, which
+ * ll_set_circular restores when a rotated list leaves circular mode */
+#define LLIST_HASH_AT_ROOT(l) \
+    (((l)->flags & (LL_HASHED | LL_CIRCULAR)) == LL_HASHED)
+
+/* Whether payloads of two lists can never match, fixed sizes differing */
+#define LLIST_SIZES_DIFFER(a, b) \
+    (!(((a)->flags | (b)->flags) & LL_VARIABLE) && (a)->element_size != (b)->element_size)
+
+
+/* Whether two payloads have the same size and bytes */
+static inline int
+_ll_payload_eq(ll_t *ptr_a, ll_node_t *ptr_node_a, ll_t *ptr_b, ll_node_t *ptr_node_b)
+{
+    size_t size = _ll_node_size(ptr_a, ptr_node_a);
+    return size == _ll_node_size(ptr_b, ptr_node_b) &&
+           (size == 0 || memcmp(_ll_node_payload(ptr_node_a), _ll_node_payload(ptr_node_b), size) == 0);
+}
+
+
+/**
+ * @brief Compares two lists element by element
+ *
+ * Both lists are walked in lockstep and payloads are compared with memcmp,
+ * which the C library vectorizes. LL_HASHED lists whose content hashes
+ * differ are told apart in O(1).
+ * @return 1 if the lists hold the same payloads in the same order, 0
+ * otherwise
+ */
+int
+ll_equal(ll_t *ptr_a, ll_t *ptr_b)
+{
+    if(ptr_a == ptr_b)
+        return 1;
+    if(ptr_a == NULL || ptr_b == NULL || LLIST_SIZES_DIFFER(ptr_a, ptr_b))
+        return 0;
+    if(LLIST_HASH_AT_ROOT(ptr_a) && LLIST_HASH_AT_ROOT(ptr_b) && ll_hash(ptr_a) != ll_hash(ptr_b))
+        return 0;
+
+    ll_node_t *ptr_node_a = ptr_a->root, *ptr_node_b = ptr_b->root;
+    while(ptr_node_a != NULL && ptr_node_b != NULL)
+    {
+        if(!_ll_payload_eq(ptr_a, ptr_node_a, ptr_b, ptr_node_b))
+            return 0;
+        ptr_node_a = _ll_next(ptr_a, ptr_node_a);
+        ptr_node_b = _ll_next(ptr_b, ptr_node_b);
+    }
+    return ptr_node_a == NULL && ptr_node_b == NULL;
+}
+
+
+/**
+ * @brief Returns a 64 bit hash of the content of the list
+ *
+ * The hash is the polynomial sum(h(x_i) * B^(n-1-i)) over the element
+ * hashes h, mixed with the length. It is computed in one streaming pass,
+ * or read in O(1) on LL_HASHED lists, whose index keeps the hash of every
+ * subtree up to date in O(log n) per insert and delete. Payloads of such
+ * lists changed in place must be reported with ll_node_changed.
+ */
+uint64_t
+ll_hash(ll_t *ptr_list)
+{
+    uint64_t state[2] = {0, 0};
+
+    if(ptr_list == NULL)
+        return 0;
+
+    if(LLIST_HASH_AT_ROOT(ptr_list))
+    {
+        _ll_osnode_t *x = (_ll_osnode_t*)ptr_list->index;
+        if(x != NULL)
+        {
+            state[0] = ((_ll_oshash_t*)(x + 1))->hash;
+            state[1] = x->size;
+        }
+    }
+    else
+    {
+        for(ll_node_t *ptr_node = ptr_list->root; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+        {
+            state[0] = state[0]*LLIST_HASH_BASE + _ll_hash_element(_ll_node_payload(ptr_node), _ll_node_size(ptr_list, ptr_node));
+            ++state[1];
+        }
+    }
+    return _ll_hash_bytes(state, sizeof(state), 0);
+}
+
+
+/**
+ * @brief Reports that the payload of a node was changed in place, so that
+ * LL_HASHED lists refresh their content hash, LL_HOTCOLD lists the
+ * fingerprint of the node and LL_STRING lists the hash of the string.
+ * Interned strings must not be changed. No-op on other lists.
+ */
+void
+ll_node_changed(ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    if(ptr_list == NULL || ptr_node == NULL)
+        return;
+    if(ptr_list->flags & LL_HASHED)
+        _ll_index_refresh(ptr_list, ptr_node);
+    if(ptr_list->cold != NULL)
+        *_ll_fingerprint(ptr_node) = _ll_hash_key(_ll_node_payload(ptr_node), ptr_list->element_size);
+    if((ptr_list->flags & LL_STRING) && ptr_list->strtab == NULL)
+    {
+        _ll_var_node_t *ptr_var = (_ll_var_node_t*)ptr_node;
+        ptr_var->hash = _ll_hash_key(ptr_var->data.payload, ptr_var->size);
+    }
+}
+
+
+typedef struct {
+    ll_t *list_a;
+    ll_t *list_b;
+    ll_node_t **a;
+    ll_node_t **b;
+    /* Furthest reaching paths, forward and backward, by diagonal */
+    ssize_t *vf;
+    ssize_t *vb;
+    ssize_t offset;
+    ll_diff_cb_t cb;
+    void *ctx;
+    ssize_t edits;
+} _ll_diff_t;
+
+
+static inline int
+_ll_diff_eq(_ll_diff_t *d, size_t i, size_t j)
+{
+    return _ll_payload_eq(d->list_a, d->a[i], d->list_b, d->b[j]);
+}
+
+
+/**
+ * @brief Finds the middle snake of a[a0, a1) against b[b0, b1), running the
+ * greedy algorithm from both ends until the paths overlap
+ * @param snake Receives the start and end points of the snake
+ */
+static void
+_ll_diff_middle(_ll_diff_t *d, size_t a0, size_t a1, size_t b0, size_t b1, size_t *snake)
+{
+    ssize_t n = a1 - a0, m = b1 - b0, delta = n - m;
+    ssize_t *vf = d->vf + d->offset, *vb = d->vb + d->offset;
+    int odd = delta & 1;
+
+    vf[1] = 0;
+    vb[1] = 0;
+    for(ssize_t k, x, y, x0, y0, dd = 0; dd <= (n + m + 1)/2; ++dd)
+    {
+        for(k = -dd; k <= dd; k += 2)
+        {
+            x = (k == -dd || (k != dd && vf[k - 1] < vf[k + 1])) ? vf[k + 1] : vf[k - 1] + 1;
+            y = x - k;
+            x0 = x;
+            y0 = y;
+            while(x < n && y < m && _ll_diff_eq(d, a0 + x, b0 + y))
+                ++x, ++y;
+            vf[k] = x;
+            if(odd && delta - k >= -(dd - 1) && delta - k <= dd - 1 && x + vb[delta - k] >= n)
+            {
+                snake[0] = a0 + x0;
+                snake[1] = b0 + y0;
+                snake[2] = a0 + x;
+                snake[3] = b0 + y;
+                return;
+            }
+        }
+        /* Backward paths run on the reversed sequences, diagonal delta - k */
+        for(k = -dd; k <= dd; k += 2)
+        {
+            x = (k == -dd || (k != dd && vb[k - 1] < vb[k + 1])) ? vb[k + 1] : vb[k - 1] + 1;
+            y = x - k;
+            x0 = x;
+            y0 = y;
+            while(x < n && y < m && _ll_diff_eq(d, a1 - 1 - x, b1 - 1 - y))
+                ++x, ++y;
+            vb[k] = x;
+            if(!odd && delta - k >= -dd && delta - k <= dd && x + vf[delta - k] >= n)
+            {
+                snake[0] = a1 - x;
+                snake[1] = b1 - y;
+                snake[2] = a1 - x0;
+                snake[3] = b1 - y0;
+                return;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Emits the edits turning a[a0, a1) into b[b0, b1), splitting the
+ * problem at its middle snake
+ */
+static void
+_ll_diff_rec(_ll_diff_t *d, size_t a0, size_t a1, size_t b0, size_t b1)
+{
+    size_t snake[4] = {0, 0, 0, 0};
+
+    while(a0 < a1 && b0 < b1 && _ll_diff_eq(d, a0, b0))
+        ++a0, ++b0;
+    while(a0 < a1 && b0 < b1 && _ll_diff_eq(d, a1 - 1, b1 - 1))
+        --a1, --b1;
+
+    if(a0 == a1 || b0 == b1)
+    {
+        for(; a0 < a1; ++a0, ++d->edits)
+            d->cb(LL_DIFF_DEL, a0, d->a[a0], d->ctx);
+        for(; b0 < b1; ++b0, ++d->edits)
+            d->cb(LL_DIFF_INS, b0, d->b[b0], d->ctx);
+        return;
+    }
+
+    _ll_diff_middle(d, a0, a1, b0, b1, snake);
+    _ll_diff_rec(d, a0, snake[0], b0, snake[1]);
+    _ll_diff_rec(d, snake[2], a1, snake[3], b1);
+}
+
+
+/**
+ * @brief Gathers the nodes of a list in an array
+ * @return The array, NULL upon failure or if the list is empty
+ */
+static ll_node_t**
+_ll_diff_nodes(ll_t *ptr_list, size_t *len)
+{
+    ll_node_t **nodes;
+
+    *len = ll_len(ptr_list);
+    if(*len == 0)
+        return NULL;
+    nodes = (ll_node_t**)malloc(*len*sizeof(ll_node_t*));
+    if(nodes == NULL)
+    {
+        perror("malloc");
+        return NULL;
+    }
+    size_t i = 0;
+    for(ll_node_t *ptr_node = ptr_list->root; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+        nodes[i++] = ptr_node;
+    return nodes;
+}
+
+
+/**
+ * @brief Computes a shortest edit script turning a into b
+ *
+ * Uses the linear space variant of Myers' O(ND) algorithm, which recurses
+ * on the middle snake of the edit graph. Memory is O(n + m): the node
+ * arrays of both lists and two vectors of furthest reaching paths.
+ * Deletions are reported with their position in a, insertions with their
+ * position in b, in increasing order of position.
+ * @return Number of edits, -1 upon failure
+ */
+ssize_t
+ll_diff(ll_t *ptr_a, ll_t *ptr_b, ll_diff_cb_t cb, void *ctx)
+{
+    _ll_diff_t d;
+    size_t n, m;
+
+    if(ptr_a == NULL || ptr_b == NULL || cb == NULL || LLIST_SIZES_DIFFER(ptr_a, ptr_b))
+        return -1;
+
+    memset(&d, 0, sizeof(d));
+    d.list_a = ptr_a;
+    d.list_b = ptr_b;
+    d.cb = cb;
+    d.ctx = ctx;
+    d.a = _ll_diff_nodes(ptr_a, &n);
+    d.b = _ll_diff_nodes(ptr_b, &m);
+    d.offset = (n + m + 1)/2 + 1;
+    d.vf = (ssize_t*)malloc((2*d.offset + 1)*sizeof(ssize_t));
+    d.vb = (ssize_t*)malloc((2*d.offset + 1)*sizeof(ssize_t));
+    if((n > 0 && d.a == NULL) || (m > 0 && d.b == NULL) || d.vf == NULL || d.vb == NULL)
+    {
+        perror("malloc");
+        d.edits = -1;
+        goto out;
+    }
+
+    _ll_diff_rec(&d, 0, n, 0, m);
+
+out:
+    free(d.vb);
+    free(d.vf);
+    free(d.b);
+    free(d.a);
+    return d.edits;
+}
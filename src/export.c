@@ -0,0 +1,940 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+#define LLIST_IO_CHUNK_SIZE               65536
+
+struct ll_import_t_internal {
+    const ll_schema_t *schema;
+    ll_format_t format;
+    ll_t *list;
+    ll_node_t *tail;
+    char *pending;
+    size_t pos;
+    size_t len;
+    size_t size;
+    size_t scan;
+    int in_string;
+    int escape;
+    int *columns;
+    size_t ncolumns;
+    int started;
+    int done;
+    int error;
+};
+
+
+static size_t
+_ll_field_width(const ll_field_t *field)
+{
+    switch(field->type)
+    {
+        case LL_FMT_U8:
+        case LL_FMT_I8:
+            return sizeof(uint8_t);
+        case LL_FMT_U16:
+        case LL_FMT_I16:
+            return sizeof(uint16_t);
+        case LL_FMT_U32:
+        case LL_FMT_I32:
+        case LL_FMT_FLOAT:
+            return sizeof(uint32_t);
+        case LL_FMT_U64:
+        case LL_FMT_I64:
+        case LL_FMT_DOUBLE:
+            return sizeof(uint64_t);
+        case LL_FMT_HEX:
+        case LL_FMT_STR:
+            return field->size;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Checks that every field of the schema lies within the record
+ */
+static int
+_ll_schema_check(const ll_schema_t *schema)
+{
+    if(schema == NULL || schema->fields == NULL || schema->nfields == 0 || schema->record_size == 0)
+        return -1;
+    for(size_t i = 0; i < schema->nfields; ++i)
+    {
+        const ll_field_t *field = &schema->fields[i];
+        size_t width = _ll_field_width(field);
+        if(field->name == NULL || width == 0 || field->offset + width > schema->record_size)
+            return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Appends a string field, quoted and escaped as the format requires
+ */
+static int
+_ll_export_str(_ll_chunk_t *chunk, ll_format_t format, const char *str, size_t len)
+{
+    /* Worst case is a JSON \u00XX escape for every byte, plus the quotes */
+    char *dst = _ll_chunk_reserve(chunk, 6*len + 2);
+    if(dst == NULL)
+        return -1;
+
+    char *ptr = dst;
+    if(format == LL_CSV)
+    {
+        /* Fields filled to their full size are not NUL terminated */
+        if(memchr(str, ',', len) == NULL && memchr(str, '"', len) == NULL &&
+           memchr(str, '\r', len) == NULL && memchr(str, '\n', len) == NULL)
+        {
+            memcpy(ptr, str, len);
+            chunk->len += len;
+            return 0;
+        }
+        *ptr++ = '"';
+        for(size_t i = 0; i < len; ++i)
+        {
+            if(str[i] == '"')
+                *ptr++ = '"';
+            *ptr++ = str[i];
+        }
+        *ptr++ = '"';
+        chunk->len += ptr - dst;
+        return 0;
+    }
+
+    *ptr++ = '"';
+    for(size_t i = 0; i < len; ++i)
+    {
+        unsigned char c = (unsigned char)str[i];
+        if(c == '"' || c == '\\')
+        {
+            *ptr++ = '\\';
+            *ptr++ = c;
+        }
+        else if(c == '\n')
+        {
+            *ptr++ = '\\';
+            *ptr++ = 'n';
+        }
+        else if(c < 0x20)
+            ptr += sprintf(ptr, "\\u%04x", c);
+        else
+            *ptr++ = c;
+    }
+    *ptr++ = '"';
+    chunk->len += ptr - dst;
+    return 0;
+}
+
+
+static int
+_ll_export_raw(_ll_chunk_t *chunk, const char *str)
+{
+    size_t len = strlen(str);
+    char *dst = _ll_chunk_reserve(chunk, len);
+    if(dst == NULL)
+        return -1;
+    memcpy(dst, str, len);
+    chunk->len += len;
+    return 0;
+}
+
+
+static int
+_ll_export_field(_ll_chunk_t *chunk, ll_format_t format, const ll_field_t *field, const char *record)
+{
+    const void *value = record + field->offset;
+
+    if(field->type == LL_FMT_STR)
+        return _ll_export_str(chunk, format, (const char*)value, strnlen((const char*)value, field->size));
+
+    if(field->type == LL_FMT_HEX)
+    {
+        char *dst = _ll_chunk_reserve(chunk, 2*field->size + 2);
+        if(dst == NULL)
+            return -1;
+        size_t len = 0;
+        if(format == LL_JSON)
+            dst[len++] = '"';
+        len += _ll_fmt_hex(dst + len, value, field->size);
+        if(format == LL_JSON)
+            dst[len++] = '"';
+        chunk->len += len;
+        return 0;
+    }
+
+    if(format == LL_JSON && (field->type == LL_FMT_FLOAT || field->type == LL_FMT_DOUBLE))
+    {
+        float f;
+        double d;
+        if(field->type == LL_FMT_FLOAT)
+            memcpy(&f, value, sizeof(f)), d = f;
+        else
+            memcpy(&d, value, sizeof(d));
+        /* JSON has no representation for nan and inf */
+        if(!isfinite(d))
+            return _ll_export_raw(chunk, "null");
+    }
+
+    char *dst = _ll_chunk_reserve(chunk, LLIST_FMT_MAX);
+    if(dst == NULL)
+        return -1;
+    chunk->len += _ll_fmt_value(dst, field->type, value, _ll_field_width(field));
+    return 0;
+}
+
+
+/**
+ * @brief Streams the records of the list to fd as CSV or as a JSON array
+ *
+ * Records are formatted into a fixed size chunk which is written out every
+ * time it fills up. CSV output starts with a header line made of the field
+ * names, JSON output has one object per record with the field names as
+ * keys. Floating point fields are written with six fractional digits.
+ * @param ptr_list Pointer to the list, whose payloads are laid out as schema.
+ * Payloads of LL_VARIABLE lists shorter than the record make the export fail.
+ * @param schema Description of the record fields
+ * @param format LL_CSV or LL_JSON
+ * @param fd Destination file descriptor
+ * @return Number of bytes written, -1 upon failure
+ */
+ssize_t
+ll_export(ll_t *ptr_list, const ll_schema_t *schema, ll_format_t format, int fd)
+{
+    _ll_chunk_t chunk;
+    size_t i;
+
+    if(ptr_list == NULL || fd < 0 || _ll_schema_check(schema) != 0 ||
+       (!(ptr_list->flags & LL_VARIABLE) && ptr_list->element_size < schema->record_size))
+        return -1;
+    if(format != LL_CSV && format != LL_JSON)
+        return -1;
+
+    if(_ll_chunk_init_fd(&chunk, LLIST_IO_CHUNK_SIZE, fd) != 0)
+        return -1;
+
+    if(format == LL_CSV)
+    {
+        for(i = 0; i < schema->nfields; ++i)
+        {
+            if((i > 0 && _ll_export_raw(&chunk, ",") != 0) ||
+               _ll_export_str(&chunk, format, schema->fields[i].name, strlen(schema->fields[i].name)) != 0)
+                goto err;
+        }
+        if(_ll_export_raw(&chunk, "\n") != 0)
+            goto err;
+    }
+    else if(_ll_export_raw(&chunk, "[\n") != 0)
+        goto err;
+
+    ll_node_t *root = ptr_list->root;
+    while(root != NULL)
+    {
+        const char *record = (const char*)ll_node_payload(root);
+        /* Payloads of LL_VARIABLE lists are checked one by one */
+        if(_ll_node_size(ptr_list, root) < schema->record_size)
+            goto err;
+        if(format == LL_JSON && _ll_export_raw(&chunk, "{") != 0)
+            goto err;
+        for(i = 0; i < schema->nfields; ++i)
+        {
+            const ll_field_t *field = &schema->fields[i];
+            if(i > 0 && _ll_export_raw(&chunk, ",") != 0)
+                goto err;
+            if(format == LL_JSON &&
+               (_ll_export_str(&chunk, format, field->name, strlen(field->name)) != 0 ||
+                _ll_export_raw(&chunk, ":") != 0))
+                goto err;
+            if(_ll_export_field(&chunk, format, field, record) != 0)
+                goto err;
+        }
+        root = _ll_next(ptr_list, root);
+        if(format == LL_CSV)
+        {
+            if(_ll_export_raw(&chunk, "\n") != 0)
+                goto err;
+        }
+        else if(_ll_export_raw(&chunk, root != NULL ? "},\n" : "}\n") != 0)
+            goto err;
+    }
+
+    if(format == LL_JSON && _ll_export_raw(&chunk, "]\n") != 0)
+        goto err;
+    if(_ll_chunk_flush(&chunk) != 0)
+        goto err;
+
+    ssize_t written = (ssize_t)chunk.flushed;
+    _ll_chunk_free(&chunk);
+    return written;
+
+err:
+    _ll_chunk_free(&chunk);
+    return -1;
+}
+
+
+/**
+ * @brief Starts an incremental import of records laid out as schema
+ *
+ * Input is passed in arbitrarily sized pieces with ll_import_feed, records
+ * split across pieces are completed by the following ones. CSV input must
+ * start with a header line naming the fields, columns are matched by name
+ * and unknown ones are skipped. JSON input is an array of flat objects.
+ * Fields missing from a record are zeroed. The schema must outlive the
+ * import.
+ * @return Pointer to the import context, NULL upon failure
+ */
+ll_import_t*
+ll_import_begin(const ll_schema_t *schema, ll_format_t format)
+{
+    if(_ll_schema_check(schema) != 0 || (format != LL_CSV && format != LL_JSON))
+        return NULL;
+
+    ll_import_t *imp = (ll_import_t*)calloc(1, sizeof(ll_import_t));
+    if(imp == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    /* Records are parsed straight into nodes allocated in bulk from slabs */
+    imp->list = _ll_new(schema->record_size, LL_POOLED);
+    if(imp->list == NULL)
+    {
+        free(imp);
+        return NULL;
+    }
+    imp->schema = schema;
+    imp->format = format;
+    return imp;
+}
+
+
+static const ll_field_t*
+_ll_schema_find(const ll_schema_t *schema, const char *name, size_t len)
+{
+    for(size_t i = 0; i < schema->nfields; ++i)
+    {
+        if(strncmp(schema->fields[i].name, name, len) == 0 && schema->fields[i].name[len] == '\0')
+            return &schema->fields[i];
+    }
+    return NULL;
+}
+
+
+static int
+_ll_hex_value(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+
+/**
+ * @brief Parses an unquoted, unescaped value into its field of the record
+ * @return 0 on success, -1 if the value is malformed or out of range
+ */
+static int
+_ll_parse_field(const ll_field_t *field, const char *tok, size_t len, char *record)
+{
+    char str[LLIST_FMT_MAX];
+    char *end = NULL;
+    void *dst = record + field->offset;
+
+    if(field->type == LL_FMT_STR)
+    {
+        if(len > field->size)
+            return -1;
+        memcpy(dst, tok, len);
+        return 0;
+    }
+    if(field->type == LL_FMT_HEX)
+    {
+        if(len != 2*field->size)
+            return -1;
+        for(size_t i = 0; i < field->size; ++i)
+        {
+            int hi = _ll_hex_value(tok[2*i]), lo = _ll_hex_value(tok[2*i + 1]);
+            if(hi < 0 || lo < 0)
+                return -1;
+            ((uint8_t*)dst)[i] = (uint8_t)(hi << 4 | lo);
+        }
+        return 0;
+    }
+
+    if(len == 0 || len >= sizeof(str))
+        return -1;
+    memcpy(str, tok, len);
+    str[len] = '\0';
+    errno = 0;
+
+    switch(field->type)
+    {
+        case LL_FMT_FLOAT:
+        {
+            float v = strtof(str, &end);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case LL_FMT_DOUBLE:
+        {
+            double v = strtod(str, &end);
+            memcpy(dst, &v, sizeof(v));
+            break;
+        }
+        case LL_FMT_I8:
+        case LL_FMT_I16:
+        case LL_FMT_I32:
+        case LL_FMT_I64:
+        {
+            long long v = strtoll(str, &end, 10);
+            int bits = 8*_ll_field_width(field);
+            if(bits < 64 && (v < -(1LL << (bits - 1)) || v >= (1LL << (bits - 1))))
+                return -1;
+            int8_t i8 = v;
+            int16_t i16 = v;
+            int32_t i32 = v;
+            int64_t i64 = v;
+            memcpy(dst, bits == 8 ? (void*)&i8 : bits == 16 ? (void*)&i16 : bits == 32 ? (void*)&i32 : (void*)&i64, bits/8);
+            break;
+        }
+        default:
+        {
+            if(str[0] == '-')
+                return -1;
+            unsigned long long v = strtoull(str, &end, 10);
+            int bits = 8*_ll_field_width(field);
+            if(bits < 64 && v >= (1ULL << bits))
+                return -1;
+            uint8_t u8 = v;
+            uint16_t u16 = v;
+            uint32_t u32 = v;
+            uint64_t u64 = v;
+            memcpy(dst, bits == 8 ? (void*)&u8 : bits == 16 ? (void*)&u16 : bits == 32 ? (void*)&u32 : (void*)&u64, bits/8);
+            break;
+        }
+    }
+    if(errno == ERANGE || end == str || *end != '\0')
+        return -1;
+    return 0;
+}
+
+
+/**
+ * @brief Splits a CSV record into fields, unquoting them in place
+ * @param cb Called with the column number and the unquoted field
+ * @return 0 on success, -1 on malformed quoting or if cb fails
+ */
+static int
+_ll_csv_split(ll_import_t *imp, char *rec, size_t len, char *record,
+              int (*cb)(ll_import_t*, size_t, char*, size_t, char*))
+{
+    size_t col = 0, i = 0;
+    for(;;)
+    {
+        char *field = rec + i, *dst = field;
+        if(i < len && rec[i] == '"')
+        {
+            for(++i;; ++i)
+            {
+                if(i >= len)
+                    return -1;
+                if(rec[i] == '"')
+                {
+                    if(i + 1 < len && rec[i + 1] == '"')
+                        ++i;
+                    else
+                        break;
+                }
+                *dst++ = rec[i];
+            }
+            ++i;
+            if(i < len && rec[i] != ',')
+                return -1;
+        }
+        else
+        {
+            while(i < len && rec[i] != ',')
+                *dst++ = rec[i++];
+        }
+        if(cb(imp, col++, field, dst - field, record) != 0)
+            return -1;
+        if(i >= len)
+            return 0;
+        ++i;
+    }
+}
+
+
+static int
+_ll_csv_header_cb(ll_import_t *imp, size_t col, char *tok, size_t len, char *record)
+{
+    (void)record;
+    int *columns = (int*)realloc(imp->columns, sizeof(int)*(col + 1));
+    if(columns == NULL)
+    {
+        perror("realloc");
+        return -1;
+    }
+    const ll_field_t *field = _ll_schema_find(imp->schema, tok, len);
+    columns[col] = field != NULL ? (int)(field - imp->schema->fields) : -1;
+    imp->columns = columns;
+    imp->ncolumns = col + 1;
+    return 0;
+}
+
+
+static int
+_ll_csv_field_cb(ll_import_t *imp, size_t col, char *tok, size_t len, char *record)
+{
+    if(col >= imp->ncolumns || imp->columns[col] < 0)
+        return 0;
+    return _ll_parse_field(&imp->schema->fields[imp->columns[col]], tok, len, record);
+}
+
+
+/**
+ * @brief Unescapes a JSON string in place, up to its closing quote
+ * @param str Pointer to the first character after the opening quote
+ * @param end Set to the first character after the closing quote
+ * @return Length of the unescaped string, -1 if malformed
+ */
+static ssize_t
+_ll_json_unescape(char *str, char *limit, char **end)
+{
+    char *src = str, *dst = str;
+    while(src < limit && *src != '"')
+    {
+        if(*src != '\\')
+        {
+            *dst++ = *src++;
+            continue;
+        }
+        if(++src >= limit)
+            return -1;
+        switch(*src++)
+        {
+            case '"': *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; break;
+            case '/': *dst++ = '/'; break;
+            case 'b': *dst++ = '\b'; break;
+            case 'f': *dst++ = '\f'; break;
+            case 'n': *dst++ = '\n'; break;
+            case 'r': *dst++ = '\r'; break;
+            case 't': *dst++ = '\t'; break;
+            case 'u':
+            {
+                uint32_t cp = 0;
+                for(int k = 0; k < 4; ++k)
+                {
+                    int v = src < limit ? _ll_hex_value(*src++) : -1;
+                    if(v < 0)
+                        return -1;
+                    cp = cp << 4 | v;
+                }
+                if(cp >= 0xd800 && cp < 0xdc00 && limit - src >= 6 && src[0] == '\\' && src[1] == 'u')
+                {
+                    /* Surrogate pair */
+                    uint32_t lo = 0;
+                    for(int k = 2; k < 6; ++k)
+                    {
+                        int v = _ll_hex_value(src[k]);
+                        if(v < 0)
+                            return -1;
+                        lo = lo << 4 | v;
+                    }
+                    if(lo >= 0xdc00 && lo < 0xe000)
+                    {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                        src += 6;
+                    }
+                }
+                if(cp < 0x80)
+                    *dst++ = cp;
+                else if(cp < 0x800)
+                {
+                    *dst++ = 0xc0 | cp >> 6;
+                    *dst++ = 0x80 | (cp & 0x3f);
+                }
+                else if(cp < 0x10000)
+                {
+                    *dst++ = 0xe0 | cp >> 12;
+                    *dst++ = 0x80 | (cp >> 6 & 0x3f);
+                    *dst++ = 0x80 | (cp & 0x3f);
+                }
+                else
+                {
+                    *dst++ = 0xf0 | cp >> 18;
+                    *dst++ = 0x80 | (cp >> 12 & 0x3f);
+                    *dst++ = 0x80 | (cp >> 6 & 0x3f);
+                    *dst++ = 0x80 | (cp & 0x3f);
+                }
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+    if(src >= limit)
+        return -1;
+    *end = src + 1;
+    return dst - str;
+}
+
+
+static char*
+_ll_json_skip_ws(char *ptr, char *limit)
+{
+    while(ptr < limit && (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r'))
+        ++ptr;
+    return ptr;
+}
+
+
+/**
+ * @brief Parses a flat JSON object into the record
+ */
+static int
+_ll_json_object(ll_import_t *imp, char *ptr, char *limit, char *record)
+{
+    ptr = _ll_json_skip_ws(ptr, limit);
+    if(ptr >= limit || *ptr++ != '{')
+        return -1;
+    ptr = _ll_json_skip_ws(ptr, limit);
+    if(ptr < limit && *ptr == '}')
+        return 0;
+
+    for(;;)
+    {
+        char *key = ptr + 1, *tok;
+        ssize_t key_len, len;
+
+        if(ptr >= limit || *ptr != '"' || (key_len = _ll_json_unescape(key, limit, &ptr)) < 0)
+            return -1;
+        ptr = _ll_json_skip_ws(ptr, limit);
+        if(ptr >= limit || *ptr++ != ':')
+            return -1;
+        ptr = _ll_json_skip_ws(ptr, limit);
+        if(ptr >= limit)
+            return -1;
+
+        const ll_field_t *field = _ll_schema_find(imp->schema, key, key_len);
+        int quoted = *ptr == '"';
+        if(quoted)
+        {
+            tok = ptr + 1;
+            if((len = _ll_json_unescape(tok, limit, &ptr)) < 0)
+                return -1;
+        }
+        else
+        {
+            tok = ptr;
+            while(ptr < limit && *ptr != ',' && *ptr != '}' && *ptr != ' ' &&
+                  *ptr != '\t' && *ptr != '\n' && *ptr != '\r')
+                ++ptr;
+            len = ptr - tok;
+            if(len == 0 || *tok == '{' || *tok == '[')
+                return -1;
+        }
+
+        if(field != NULL)
+        {
+            const char *value = tok;
+            if(!quoted && len == 4 && strncmp(tok, "null", 4) == 0)
+            {
+                /* Non-finite floats are exported as null, other fields stay zero */
+                if(field->type != LL_FMT_FLOAT && field->type != LL_FMT_DOUBLE)
+                    len = -1;
+                else
+                    value = "nan", len = 3;
+            }
+            else if(!quoted && len == 4 && strncmp(tok, "true", 4) == 0)
+                value = "1", len = 1;
+            else if(!quoted && len == 5 && strncmp(tok, "false", 5) == 0)
+                value = "0", len = 1;
+            if(len >= 0 && _ll_parse_field(field, value, len, record) != 0)
+                return -1;
+        }
+
+        ptr = _ll_json_skip_ws(ptr, limit);
+        if(ptr >= limit)
+            return -1;
+        if(*ptr == '}')
+            return 0;
+        if(*ptr++ != ',')
+            return -1;
+        ptr = _ll_json_skip_ws(ptr, limit);
+    }
+}
+
+
+/**
+ * @brief Parses one complete record and appends it to the list
+ */
+static int
+_ll_import_record(ll_import_t *imp, char *rec, size_t len)
+{
+    if(imp->format == LL_CSV && len > 0 && rec[len - 1] == '\r')
+        --len;
+    if(imp->format == LL_CSV && len == 0)
+        return 0;
+
+    if(imp->format == LL_CSV && !imp->started)
+    {
+        imp->started = 1;
+        return _ll_csv_split(imp, rec, len, NULL, _ll_csv_header_cb);
+    }
+
+    ll_node_t *ptr_node = _ll_node_new(imp->list, NULL);
+    if(ptr_node == NULL)
+        return -1;
+    char *record = (char*)ll_node_payload(ptr_node);
+    memset(record, 0, imp->schema->record_size);
+
+    int ret;
+    if(imp->format == LL_CSV)
+        ret = _ll_csv_split(imp, rec, len, record, _ll_csv_field_cb);
+    else
+        ret = _ll_json_object(imp, rec, rec + len, record);
+    if(ret != 0)
+    {
+        _ll_free_node(imp->list, ptr_node);
+        return -1;
+    }
+
+    if(imp->tail == NULL)
+        imp->list->root = ptr_node;
+    else
+    {
+        imp->tail->next = ptr_node;
+        ptr_node->prev = imp->tail;
+    }
+    imp->tail = ptr_node;
+    ++imp->list->len;
+    return 0;
+}
+
+
+/**
+ * @brief Finds the end of the next record in the pending input
+ *
+ * The scan resumes where the previous call stopped, so every byte of input
+ * is looked at once even when a record spans several pieces.
+ * @return Offset one past the record, which starts at imp->pos, 0 if the
+ * record is not complete yet and -1 on malformed input
+ */
+static ssize_t
+_ll_import_next(ll_import_t *imp)
+{
+    const char *buff = imp->pending;
+
+    if(imp->format == LL_JSON && imp->scan == imp->pos)
+    {
+        /* Skip the array delimiters and the separators between objects */
+        while(imp->pos < imp->len)
+        {
+            char c = buff[imp->pos];
+            if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                ++imp->pos;
+            else if(c == '[' && !imp->started)
+            {
+                imp->started = 1;
+                ++imp->pos;
+            }
+            else if((c == ',' || c == ']') && imp->started && !imp->done)
+            {
+                imp->done = c == ']';
+                ++imp->pos;
+            }
+            else if(c == '{' && imp->started && !imp->done)
+                break;
+            else
+                return -1;
+        }
+        imp->scan = imp->pos;
+    }
+
+    for(; imp->scan < imp->len; ++imp->scan)
+    {
+        char c = buff[imp->scan];
+        if(imp->format == LL_CSV)
+        {
+            if(c == '"')
+                imp->in_string = !imp->in_string;
+            else if(c == '\n' && !imp->in_string)
+                return ++imp->scan;
+        }
+        else if(imp->escape)
+            imp->escape = 0;
+        else if(imp->in_string)
+        {
+            if(c == '\\')
+                imp->escape = 1;
+            else if(c == '"')
+                imp->in_string = 0;
+        }
+        else if(c == '"')
+            imp->in_string = 1;
+        else if(c == '}')
+            return ++imp->scan;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Passes the next piece of input to the import
+ * @return 0 on success, -1 on malformed input or allocation failure. After
+ * a failure the import can only be ended.
+ */
+int
+ll_import_feed(ll_import_t *imp, const char *buff, size_t len)
+{
+    if(imp == NULL || (buff == NULL && len > 0) || imp->error)
+        return -1;
+
+    if(imp->size - imp->len < len)
+    {
+        size_t new_size = imp->size > 0 ? imp->size : LLIST_IO_CHUNK_SIZE;
+        while(new_size - imp->len < len)
+            new_size *= 2;
+        char *pending = (char*)realloc(imp->pending, new_size);
+        if(pending == NULL)
+        {
+            perror("realloc");
+            imp->error = 1;
+            return -1;
+        }
+        imp->pending = pending;
+        imp->size = new_size;
+    }
+    if(len > 0)
+        memcpy(imp->pending + imp->len, buff, len);
+    imp->len += len;
+
+    ssize_t end;
+    while((end = _ll_import_next(imp)) > 0)
+    {
+        size_t rec_len = end - imp->pos - (imp->format == LL_CSV ? 1 : 0);
+        if(_ll_import_record(imp, imp->pending + imp->pos, rec_len) != 0)
+            break;
+        imp->pos = imp->scan = end;
+        imp->in_string = imp->escape = 0;
+    }
+    if(end != 0)
+    {
+        imp->error = 1;
+        return -1;
+    }
+
+    /* Keep only the incomplete record for the next piece */
+    if(imp->pos > 0)
+        memmove(imp->pending, imp->pending + imp->pos, imp->len - imp->pos);
+    imp->len -= imp->pos;
+    imp->scan -= imp->pos;
+    imp->pos = 0;
+    return 0;
+}
+
+
+/**
+ * @brief Completes the import and releases the context
+ *
+ * A last CSV record not terminated by a newline is parsed here. JSON input
+ * must have been a complete array.
+ * @return The list of imported records, possibly empty, NULL if the import
+ * failed at any point
+ */
+ll_t*
+ll_import_end(ll_import_t *imp)
+{
+    if(imp == NULL)
+        return NULL;
+
+    ll_t *ptr_list = imp->list;
+    int error = imp->error;
+    if(!error && imp->format == LL_CSV && imp->len > 0)
+        error = imp->in_string || _ll_import_record(imp, imp->pending, imp->len) != 0;
+    if(!error && imp->format == LL_JSON)
+        error = !imp->done || imp->len > 0;
+
+    free(imp->pending);
+    free(imp->columns);
+    free(imp);
+    if(error)
+    {
+        ll_destroy(ptr_list);
+        return NULL;
+    }
+    return ptr_list;
+}
+
+
+/**
+ * @brief Imports all the records readable from fd, see ll_import_begin
+ * @return The list of imported records, NULL upon failure
+ */
+ll_t*
+ll_import_fd(int fd, const ll_schema_t *schema, ll_format_t format)
+{
+    if(fd < 0)
+        return NULL;
+    ll_import_t *imp = ll_import_begin(schema, format);
+    if(imp == NULL)
+        return NULL;
+
+    char *buff = (char*)malloc(LLIST_IO_CHUNK_SIZE);
+    if(buff == NULL)
+    {
+        perror("malloc");
+        imp->error = 1;
+        return ll_import_end(imp);
+    }
+    for(;;)
+    {
+        ssize_t len = read(fd, buff, LLIST_IO_CHUNK_SIZE);
+        if(len == -1 && errno == EINTR)
+            continue;
+        if(len == -1)
+        {
+            perror("read");
+            imp->error = 1;
+        }
+        if(len <= 0 || ll_import_feed(imp, buff, len) != 0)
+            break;
+    }
+    free(buff);
+    return ll_import_end(imp);
+}
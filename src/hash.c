@@ -0,0 +1,79 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+#define LLIST_HASH_M                      0xc6a4a7935bd1e995ULL
+#define LLIST_HASH_R                      47
+
+
+/**
+ * @brief Hashes len bytes to 64 bits (MurmurHash64A)
+ */
+uint64_t
+_ll_hash_bytes(const void *data, size_t len, uint64_t seed)
+{
+    const uint8_t *ptr = (const uint8_t*)data;
+    uint64_t h = seed ^ (len * LLIST_HASH_M);
+
+    while(len >= 8)
+    {
+        uint64_t k;
+        memcpy(&k, ptr, sizeof(k));
+        k *= LLIST_HASH_M;
+        k ^= k >> LLIST_HASH_R;
+        k *= LLIST_HASH_M;
+        h ^= k;
+        h *= LLIST_HASH_M;
+        ptr += 8;
+        len -= 8;
+    }
+
+    switch(len)
+    {
+        case 7: h ^= (uint64_t)ptr[6] << 48; /* fall through */
+        case 6: h ^= (uint64_t)ptr[5] << 40; /* fall through */
+        case 5: h ^= (uint64_t)ptr[4] << 32; /* fall through */
+        case 4: h ^= (uint64_t)ptr[3] << 24; /* fall through */
+        case 3: h ^= (uint64_t)ptr[2] << 16; /* fall through */
+        case 2: h ^= (uint64_t)ptr[1] << 8;  /* fall through */
+        case 1: h ^= (uint64_t)ptr[0];
+                h *= LLIST_HASH_M;
+    }
+
+    h ^= h >> LLIST_HASH_R;
+    h *= LLIST_HASH_M;
+    h ^= h >> LLIST_HASH_R;
+    return h;
+}
+
+
+/**
+ * @brief Hash of a single element, the term of the content hash of lists
+ */
+uint64_t
+_ll_hash_element(const void *payload, size_t size)
+{
+    return _ll_hash_bytes(payload, size, LLIST_HASH_BASE);
+}
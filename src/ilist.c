@@ -0,0 +1,345 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/ilist.h>
+#include "ll_internal.h"
+
+/* Levels of the skip structure, the first one being the list itself */
+#define LLIST_ILIST_LEVELS                12
+
+typedef struct {
+    ll_range_t range;
+    size_t height;
+    /* Forward pointers of levels 1 and above */
+    ll_node_t *skip[LLIST_ILIST_LEVELS - 1];
+} _ll_ilist_entry_t;
+
+struct ll_ilist_t_internal {
+    ll_t *list;
+    size_t len;
+    size_t height;
+    uint64_t seed;
+    ll_node_t *head[LLIST_ILIST_LEVELS];
+};
+
+
+/**
+ * @brief Creates an empty set of ranges
+ *
+ * Ranges are kept sorted and disjoint in a list, coalescing on insert the
+ * ranges which overlap or touch. Nodes also carry the forward pointers of
+ * a skip list, so lookups take O(log n) instead of walking the list.
+ * @return Pointer to the set, NULL upon failure
+ */
+ll_ilist_t*
+ll_ilist_new(void)
+{
+    ll_ilist_t *ilist = (ll_ilist_t*)calloc(1, sizeof(ll_ilist_t));
+    if(ilist == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    ilist->height = 1;
+    ilist->seed = 0x9e3779b97f4a7c15ULL;
+    ilist->list = _ll_new(sizeof(_ll_ilist_entry_t), LL_POOLED);
+    if(ilist->list == NULL)
+    {
+        free(ilist);
+        return NULL;
+    }
+    return ilist;
+}
+
+
+void
+ll_ilist_destroy(ll_ilist_t *ilist)
+{
+    if(ilist == NULL)
+        return;
+    ll_destroy(ilist->list);
+    free(ilist);
+}
+
+
+/**
+ * @brief Returns the number of disjoint ranges
+ */
+size_t
+ll_ilist_len(ll_ilist_t *ilist)
+{
+    return ilist != NULL ? ilist->len : 0;
+}
+
+
+/**
+ * @brief Returns the list of ranges sorted by start. Payloads begin with an
+ * ll_range_t. The list must not be modified.
+ */
+ll_t*
+ll_ilist_list(ll_ilist_t *ilist)
+{
+    return ilist != NULL ? ilist->list : NULL;
+}
+
+
+static inline _ll_ilist_entry_t*
+_ll_ilist_entry(ll_node_t *ptr_node)
+{
+    return (_ll_ilist_entry_t*)_ll_node_payload(ptr_node);
+}
+
+
+/**
+ * @brief Returns the forward pointer of level l >= 1 of a node, or of the
+ * head when the node is NULL
+ */
+static inline ll_node_t**
+_ll_ilist_fwd(ll_ilist_t *ilist, ll_node_t *ptr_node, size_t l)
+{
+    return ptr_node != NULL ? &_ll_ilist_entry(ptr_node)->skip[l - 1] : &ilist->head[l];
+}
+
+
+/**
+ * @brief Finds the last range starting before x
+ * @param update Receives, for each level, the last node of that level
+ * starting before x, NULL standing for the head. May be NULL.
+ * @return The node found, NULL if no range starts before x
+ */
+static ll_node_t*
+_ll_ilist_search(ll_ilist_t *ilist, uint64_t x, ll_node_t **update)
+{
+    ll_node_t *ptr_node = NULL;
+    ll_node_t *ptr_next;
+
+    for(size_t l = ilist->height - 1; l > 0; --l)
+    {
+        while((ptr_next = *_ll_ilist_fwd(ilist, ptr_node, l)) != NULL &&
+              _ll_ilist_entry(ptr_next)->range.start < x)
+            ptr_node = ptr_next;
+        if(update != NULL)
+            update[l] = ptr_node;
+    }
+
+    ptr_next = ptr_node != NULL ? ptr_node->next : ilist->list->root;
+    while(ptr_next != NULL && _ll_ilist_entry(ptr_next)->range.start < x)
+    {
+        ptr_node = ptr_next;
+        ptr_next = ptr_node->next;
+    }
+    if(update != NULL)
+    {
+        update[0] = ptr_node;
+        for(size_t l = ilist->height; l < LLIST_ILIST_LEVELS; ++l)
+            update[l] = NULL;
+    }
+    return ptr_node;
+}
+
+
+/**
+ * @brief Links an unlinked node holding a range right after update[0], the
+ * predecessors at each level being in update, and makes it the new
+ * predecessor
+ */
+static void
+_ll_ilist_link(ll_ilist_t *ilist, ll_node_t **update, ll_node_t *ptr_node, uint64_t start, uint64_t end)
+{
+    /* Geometric heights with p = 1/4 */
+    size_t height = 1;
+    ilist->seed ^= ilist->seed << 13;
+    ilist->seed ^= ilist->seed >> 7;
+    ilist->seed ^= ilist->seed << 17;
+    for(uint64_t bits = ilist->seed; height < LLIST_ILIST_LEVELS && (bits & 3) == 0; bits >>= 2)
+        ++height;
+    if(height > ilist->height)
+        ilist->height = height;
+
+    _ll_ilist_entry_t *entry = _ll_ilist_entry(ptr_node);
+    entry->range.start = start;
+    entry->range.end = end;
+    entry->height = height;
+    _ll_link_after(ilist->list, update[0], ptr_node);
+    update[0] = ptr_node;
+    for(size_t l = 1; l < height; ++l)
+    {
+        ll_node_t **fwd = _ll_ilist_fwd(ilist, update[l], l);
+        entry->skip[l - 1] = *fwd;
+        *fwd = ptr_node;
+        update[l] = ptr_node;
+    }
+    ++ilist->len;
+}
+
+
+/**
+ * @brief Creates a range right after update[0], see _ll_ilist_link
+ * @return The new node, NULL upon failure
+ */
+static ll_node_t*
+_ll_ilist_insert(ll_ilist_t *ilist, ll_node_t **update, uint64_t start, uint64_t end)
+{
+    ll_node_t *ptr_node = _ll_node_new(ilist->list, NULL);
+    if(ptr_node == NULL)
+        return NULL;
+    _ll_ilist_link(ilist, update, ptr_node, start, end);
+    return ptr_node;
+}
+
+
+/**
+ * @brief Removes a node whose predecessors at each level are in update
+ */
+static void
+_ll_ilist_remove(ll_ilist_t *ilist, ll_node_t **update, ll_node_t *ptr_node)
+{
+    _ll_ilist_entry_t *entry = _ll_ilist_entry(ptr_node);
+    for(size_t l = 1; l < entry->height; ++l)
+        *_ll_ilist_fwd(ilist, update[l], l) = entry->skip[l - 1];
+    _ll_unlink(ilist->list, ptr_node);
+    _ll_free_node(ilist->list, ptr_node);
+    --ilist->len;
+}
+
+
+/**
+ * @brief Adds [start, end) to the set, merging it with the ranges it
+ * overlaps or touches
+ * @return 0 on success, -1 upon failure or if the range is empty
+ */
+int
+ll_ilist_add(ll_ilist_t *ilist, uint64_t start, uint64_t end)
+{
+    ll_node_t *update[LLIST_ILIST_LEVELS];
+
+    if(ilist == NULL || start >= end)
+        return -1;
+
+    /* Last range starting at or before start, extended if it reaches it */
+    ll_node_t *ptr_node = _ll_ilist_search(ilist, start + 1, update);
+    if(ptr_node == NULL || _ll_ilist_entry(ptr_node)->range.end < start)
+    {
+        ptr_node = _ll_ilist_insert(ilist, update, start, end);
+        if(ptr_node == NULL)
+            return -1;
+    }
+
+    ll_range_t *range = &_ll_ilist_entry(ptr_node)->range;
+    if(range->end < end)
+        range->end = end;
+    /* Swallow the following ranges which now overlap or touch */
+    while(ptr_node->next != NULL && _ll_ilist_entry(ptr_node->next)->range.start <= range->end)
+    {
+        ll_node_t *ptr_next = ptr_node->next;
+        if(range->end < _ll_ilist_entry(ptr_next)->range.end)
+            range->end = _ll_ilist_entry(ptr_next)->range.end;
+        _ll_ilist_remove(ilist, update, ptr_next);
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Removes [start, end) from the set, trimming the ranges which
+ * straddle its bounds and splitting the one which contains it
+ * @return 0 on success, -1 upon failure or if the range is empty
+ */
+int
+ll_ilist_del(ll_ilist_t *ilist, uint64_t start, uint64_t end)
+{
+    ll_node_t *update[LLIST_ILIST_LEVELS];
+
+    if(ilist == NULL || start >= end)
+        return -1;
+
+    ll_node_t *ptr_node = _ll_ilist_search(ilist, start, update);
+    if(ptr_node != NULL && _ll_ilist_entry(ptr_node)->range.end > start)
+    {
+        ll_range_t *range = &_ll_ilist_entry(ptr_node)->range;
+        if(range->end > end)
+        {
+            /* The range splits in two, allocate before changing anything */
+            ll_node_t *ptr_upper = _ll_node_new(ilist->list, NULL);
+            if(ptr_upper == NULL)
+                return -1;
+            _ll_ilist_link(ilist, update, ptr_upper, end, range->end);
+            range->end = start;
+            return 0;
+        }
+        range->end = start;
+    }
+
+    /* Ranges starting within [start, end) go away or lose their head */
+    ptr_node = ptr_node != NULL ? ptr_node->next : ilist->list->root;
+    while(ptr_node != NULL && _ll_ilist_entry(ptr_node)->range.start < end)
+    {
+        ll_range_t *range = &_ll_ilist_entry(ptr_node)->range;
+        if(range->end > end)
+        {
+            range->start = end;
+            break;
+        }
+        ll_node_t *ptr_next = ptr_node->next;
+        _ll_ilist_remove(ilist, update, ptr_node);
+        ptr_node = ptr_next;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Returns the range containing point in O(log n), NULL if none
+ */
+ll_node_t*
+ll_ilist_find(ll_ilist_t *ilist, uint64_t point)
+{
+    if(ilist == NULL || point == UINT64_MAX)
+        return NULL;
+    ll_node_t *ptr_node = _ll_ilist_search(ilist, point + 1, NULL);
+    if(ptr_node == NULL || _ll_ilist_entry(ptr_node)->range.end <= point)
+        return NULL;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Returns the first range overlapping [start, end) in O(log n), NULL
+ * if none. The others follow through the next links of the list, as long
+ * as they start before end.
+ */
+ll_node_t*
+ll_ilist_first(ll_ilist_t *ilist, uint64_t start, uint64_t end)
+{
+    if(ilist == NULL || start >= end)
+        return NULL;
+    ll_node_t *ptr_node = _ll_ilist_search(ilist, start + 1, NULL);
+    if(ptr_node != NULL && _ll_ilist_entry(ptr_node)->range.end > start)
+        return ptr_node;
+    ptr_node = ptr_node != NULL ? ptr_node->next : ilist->list->root;
+    if(ptr_node == NULL || _ll_ilist_entry(ptr_node)->range.start >= end)
+        return NULL;
+    return ptr_node;
+}
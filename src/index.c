@@ -0,0 +1,342 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+/*
+ * Order statistic index of LL_INDEXED lists: a treap whose in-order
+ * sequence is the order of the list, each node counting the size of its
+ * subtree. Priorities come from hashing the node address, so the expected
+ * depth is O(log n) without storing a random state. On LL_HASHED lists
+ * each node also holds the polynomial hash of its subtree, so the hash of
+ * the whole list is found at the root.
+ */
+
+static inline uint32_t
+_ll_index_size(_ll_osnode_t *x)
+{
+    return x != NULL ? x->size : 0;
+}
+
+
+static inline _ll_oshash_t*
+_ll_oshash(_ll_osnode_t *x)
+{
+    return (_ll_oshash_t*)(x + 1);
+}
+
+
+/**
+ * @brief Recomputes the size, and the hash on LL_HASHED lists, of x from
+ * its children
+ */
+static void
+_ll_index_pull(ll_t *ptr_list, _ll_osnode_t *x)
+{
+    x->size = 1 + _ll_index_size(x->left) + _ll_index_size(x->right);
+    if(!(ptr_list->flags & LL_HASHED))
+        return;
+
+    _ll_oshash_t *h = _ll_oshash(x);
+    uint64_t left_hash = 0, left_pow = 1, right_hash = 0, right_pow = 1;
+    if(x->left != NULL)
+    {
+        left_hash = _ll_oshash(x->left)->hash;
+        left_pow = _ll_oshash(x->left)->pow;
+    }
+    if(x->right != NULL)
+    {
+        right_hash = _ll_oshash(x->right)->hash;
+        right_pow = _ll_oshash(x->right)->pow;
+    }
+    h->hash = (left_hash*LLIST_HASH_BASE + h->self)*right_pow + right_hash;
+    h->pow = left_pow*LLIST_HASH_BASE*right_pow;
+}
+
+
+static inline void
+_ll_index_replace(ll_t *ptr_list, _ll_osnode_t *x, _ll_osnode_t *y)
+{
+    if(x->parent == NULL)
+        ptr_list->index = y;
+    else if(x->parent->left == x)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+    if(y != NULL)
+        y->parent = x->parent;
+}
+
+
+/**
+ * @brief Rotates x above its parent, keeping the in-order sequence
+ */
+static void
+_ll_index_rotate_up(ll_t *ptr_list, _ll_osnode_t *x)
+{
+    _ll_osnode_t *p = x->parent;
+
+    _ll_index_replace(ptr_list, p, x);
+    if(p->left == x)
+    {
+        p->left = x->right;
+        if(x->right != NULL)
+            x->right->parent = p;
+        x->right = p;
+    }
+    else
+    {
+        p->right = x->left;
+        if(x->left != NULL)
+            x->left->parent = p;
+        x->left = p;
+    }
+    p->parent = x;
+    _ll_index_pull(ptr_list, p);
+    _ll_index_pull(ptr_list, x);
+}
+
+
+/**
+ * @brief Indexes a node linked right after pos, or at the head if pos is
+ * NULL. Must run before the list links are updated.
+ */
+void
+_ll_index_link(ll_t *ptr_list, ll_node_t *ptr_pos, ll_node_t *ptr_node)
+{
+    _ll_osnode_t *x = _ll_osnode(ptr_list, ptr_node);
+    _ll_osnode_t *y;
+
+    x->left = x->right = x->parent = NULL;
+    x->priority = (uint32_t)_ll_hash_key(&ptr_node, sizeof(ptr_node));
+    if(ptr_list->flags & LL_HASHED)
+        _ll_oshash(x)->self = _ll_hash_element(_ll_node_payload(ptr_node), ptr_list->element_size);
+    _ll_index_pull(ptr_list, x);
+
+    if(ptr_list->index == NULL)
+    {
+        ptr_list->index = x;
+        return;
+    }
+
+    if(ptr_pos != NULL)
+    {
+        /* In-order successor of pos */
+        y = _ll_osnode(ptr_list, ptr_pos);
+        if(y->right == NULL)
+            y->right = x;
+        else
+        {
+            for(y = y->right; y->left != NULL; y = y->left)
+                ;
+            y->left = x;
+        }
+    }
+    else
+    {
+        /* In-order predecessor of the root, which for a linear list is the
+         * leftmost position */
+        y = _ll_osnode(ptr_list, ptr_list->root);
+        if(y->left == NULL)
+            y->left = x;
+        else
+        {
+            for(y = y->left; y->right != NULL; y = y->right)
+                ;
+            y->right = x;
+        }
+    }
+    x->parent = y;
+    for(; y != NULL; y = y->parent)
+        _ll_index_pull(ptr_list, y);
+
+    while(x->parent != NULL && x->priority < x->parent->priority)
+        _ll_index_rotate_up(ptr_list, x);
+}
+
+
+/**
+ * @brief Removes a node from the index
+ */
+void
+_ll_index_unlink(ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    _ll_osnode_t *x = _ll_osnode(ptr_list, ptr_node);
+
+    /* Sink x until it has at most one child */
+    while(x->left != NULL && x->right != NULL)
+    {
+        _ll_osnode_t *c = x->left->priority < x->right->priority ? x->left : x->right;
+        _ll_index_rotate_up(ptr_list, c);
+    }
+    _ll_osnode_t *p = x->parent;
+    _ll_index_replace(ptr_list, x, x->left != NULL ? x->left : x->right);
+    for(; p != NULL; p = p->parent)
+        _ll_index_pull(ptr_list, p);
+}
+
+
+/**
+ * @brief Refreshes the hashes on the path from a node whose payload
+ * changed to the root
+ */
+void
+_ll_index_refresh(ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    if(!(ptr_list->flags & LL_HASHED))
+        return;
+    _ll_osnode_t *x = _ll_osnode(ptr_list, ptr_node);
+    _ll_oshash(x)->self = _ll_hash_element(_ll_node_payload(ptr_node), ptr_list->element_size);
+    for(; x != NULL; x = x->parent)
+        _ll_index_pull(ptr_list, x);
+}
+
+
+/**
+ * @brief Returns the in-order position of a node within the index
+ */
+size_t
+_ll_index_rank(ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    _ll_osnode_t *x = _ll_osnode(ptr_list, ptr_node);
+    size_t rank = _ll_index_size(x->left);
+
+    for(; x->parent != NULL; x = x->parent)
+    {
+        if(x->parent->right == x)
+            rank += _ll_index_size(x->parent->left) + 1;
+    }
+    return rank;
+}
+
+
+/**
+ * @brief Returns the list node at a given in-order position of the index
+ */
+ll_node_t*
+_ll_index_select(ll_t *ptr_list, size_t pos)
+{
+    _ll_osnode_t *x = (_ll_osnode_t*)ptr_list->index;
+
+    while(x != NULL)
+    {
+        size_t left = _ll_index_size(x->left);
+        if(pos == left)
+            break;
+        if(pos < left)
+            x = x->left;
+        else
+        {
+            pos -= left + 1;
+            x = x->right;
+        }
+    }
+    if(x == NULL)
+        return NULL;
+    /* Pooled layout: node, data descriptor, payload, index node */
+    char *payload = (char*)x - _ll_payload_span(ptr_list);
+    return (ll_node_t*)(payload - _ll_payload_offset(ptr_list));
+}
+
+
+/**
+ * @brief Splits the subtree t into its first k nodes and the rest
+ */
+static void
+_ll_index_split(ll_t *ptr_list, _ll_osnode_t *t, size_t k, _ll_osnode_t **l, _ll_osnode_t **r)
+{
+    _ll_osnode_t *a, *b;
+
+    if(t == NULL)
+    {
+        *l = *r = NULL;
+        return;
+    }
+    if(_ll_index_size(t->left) < k)
+    {
+        _ll_index_split(ptr_list, t->right, k - _ll_index_size(t->left) - 1, &a, &b);
+        t->right = a;
+        if(a != NULL)
+            a->parent = t;
+        *l = t;
+        *r = b;
+    }
+    else
+    {
+        _ll_index_split(ptr_list, t->left, k, &a, &b);
+        t->left = b;
+        if(b != NULL)
+            b->parent = t;
+        *l = a;
+        *r = t;
+    }
+    _ll_index_pull(ptr_list, t);
+}
+
+
+/**
+ * @brief Joins two subtrees, all of a coming before all of b in order
+ */
+static _ll_osnode_t*
+_ll_index_merge(ll_t *ptr_list, _ll_osnode_t *a, _ll_osnode_t *b)
+{
+    if(a == NULL)
+        return b;
+    if(b == NULL)
+        return a;
+    if(a->priority < b->priority)
+    {
+        a->right = _ll_index_merge(ptr_list, a->right, b);
+        a->right->parent = a;
+        _ll_index_pull(ptr_list, a);
+        return a;
+    }
+    b->left = _ll_index_merge(ptr_list, a, b->left);
+    b->left->parent = b;
+    _ll_index_pull(ptr_list, b);
+    return b;
+}
+
+
+/**
+ * @brief Rotates the in-order sequence of the index so that the root of
+ * the list comes first, in O(log n). Circular lists may leave the root
+ * anywhere in the index, linear ones expect it first.
+ */
+void
+_ll_index_reroot(ll_t *ptr_list)
+{
+    _ll_osnode_t *l, *r;
+
+    if(ptr_list->root == NULL)
+        return;
+    size_t k = _ll_index_rank(ptr_list, ptr_list->root);
+    if(k == 0)
+        return;
+    _ll_index_split(ptr_list, (_ll_osnode_t*)ptr_list->index, k, &l, &r);
+    l->parent = r->parent = NULL;
+    _ll_osnode_t *x = _ll_index_merge(ptr_list, r, l);
+    x->parent = NULL;
+    ptr_list->index = x;
+}
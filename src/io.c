@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX                           1024
+#endif
+
+
+/**
+ * @brief Writes all the buffers described by iov, resuming after partial writes
+ *
+ * The iovec array is consumed in place. Non-blocking descriptors are waited
+ * on with poll until they become writable again.
+ * @return 0 on success, -1 on failure with errno set by writev
+ */
+int
+_ll_writev_all(int fd, struct iovec *iov, int iovcnt)
+{
+    while(iovcnt > 0)
+    {
+        ssize_t written = writev(fd, iov, iovcnt);
+        if(written == -1)
+        {
+            if(errno == EINTR)
+                continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                if(poll(&pfd, 1, -1) == -1 && errno != EINTR)
+                    return -1;
+                continue;
+            }
+            return -1;
+        }
+
+        /* Skip the buffers written in full, then trim the partial one */
+        while(iovcnt > 0 && (size_t)written >= iov->iov_len)
+        {
+            written -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if(iovcnt > 0)
+        {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Writes the raw payloads of the list to a file descriptor
+ *
+ * Payloads are not copied: each batch of up to IOV_MAX buffers points
+ * directly at the nodes, so the list must not be modified during the call.
+ * Payloads of LL_VARIABLE lists are written with their own size.
+ * @param ptr_list Pointer to the list
+ * @param fd Destination file descriptor, either blocking or non-blocking
+ * @param sep Separator written between consecutive payloads, may be NULL
+ * @param sep_len Length of the separator, 0 for none
+ * @return Number of bytes written, -1 upon failure
+ */
+ssize_t
+ll_writev(ll_t *ptr_list, int fd, const void *sep, size_t sep_len)
+{
+    struct iovec iov[IOV_MAX];
+    ssize_t total = 0;
+
+    if(ptr_list == NULL || fd < 0 || (sep == NULL && sep_len > 0))
+        return -1;
+
+    ll_node_t *root = ptr_list->root;
+    while(root != NULL)
+    {
+        int iovcnt = 0;
+        while(root != NULL && iovcnt + 2 <= IOV_MAX)
+        {
+            if(sep_len > 0 && root != ptr_list->root)
+            {
+                iov[iovcnt].iov_base = (void*)sep;
+                iov[iovcnt++].iov_len = sep_len;
+                total += sep_len;
+            }
+            iov[iovcnt].iov_base = ll_node_payload(root);
+            iov[iovcnt++].iov_len = _ll_node_size(ptr_list, root);
+            total += _ll_node_size(ptr_list, root);
+            root = _ll_next(ptr_list, root);
+        }
+        if(_ll_writev_all(fd, iov, iovcnt) == -1)
+        {
+            perror("writev");
+            return -1;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,311 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/lhm.h>
+#include "ll_internal.h"
+
+#define LLIST_LHM_MIN_BUCKETS             8
+
+/* Buckets of the old table migrated by every put or del while resizing */
+#define LLIST_LHM_REHASH_STEP             4
+
+/* Trailer of each payload, chaining the entries of a bucket */
+typedef struct {
+    ll_node_t *chain;
+    uint64_t hash;
+} _ll_lhm_meta_t;
+
+struct ll_lhm_t_internal {
+    ll_t *list;
+    ll_node_t *tail;
+    size_t key_size;
+    size_t value_size;
+    size_t value_offset;
+    size_t meta_offset;
+    size_t len;
+    /* While resizing, entries move from table 0 to table 1 bucket by bucket,
+     * starting from bucket rehash of table 0 */
+    ll_node_t **buckets[2];
+    size_t mask[2];
+    size_t rehash;
+};
+
+
+/**
+ * @brief Creates an empty map which iterates in insertion order
+ *
+ * Entries are nodes of a list in insertion order, whose payload is the key
+ * followed by the value and by the chaining trailer of the hash table.
+ * Tables grow incrementally, so no single put pays for rehashing the whole
+ * map.
+ * @return Pointer to the map, NULL upon failure
+ */
+ll_lhm_t*
+ll_lhm_new(size_t key_size, size_t value_size)
+{
+    if(key_size == 0)
+        return NULL;
+
+    ll_lhm_t *lhm = (ll_lhm_t*)calloc(1, sizeof(ll_lhm_t));
+    if(lhm == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    lhm->key_size = key_size;
+    lhm->value_size = value_size;
+    lhm->value_offset = (key_size + 7) & ~(size_t)7;
+    lhm->meta_offset = (lhm->value_offset + value_size + 7) & ~(size_t)7;
+    lhm->mask[0] = LLIST_LHM_MIN_BUCKETS - 1;
+    lhm->buckets[0] = (ll_node_t**)calloc(LLIST_LHM_MIN_BUCKETS, sizeof(ll_node_t*));
+    lhm->list = _ll_new(lhm->meta_offset + sizeof(_ll_lhm_meta_t), LL_POOLED);
+    if(lhm->buckets[0] == NULL || lhm->list == NULL)
+    {
+        perror("calloc");
+        ll_lhm_destroy(lhm);
+        return NULL;
+    }
+    return lhm;
+}
+
+
+void
+ll_lhm_destroy(ll_lhm_t *lhm)
+{
+    if(lhm == NULL)
+        return;
+    ll_destroy(lhm->list);
+    free(lhm->buckets[0]);
+    free(lhm->buckets[1]);
+    free(lhm);
+}
+
+
+size_t
+ll_lhm_len(ll_lhm_t *lhm)
+{
+    return lhm != NULL ? lhm->len : 0;
+}
+
+
+/**
+ * @brief Returns the list of entries in insertion order. The list must not
+ * be modified.
+ */
+ll_t*
+ll_lhm_list(ll_lhm_t *lhm)
+{
+    return lhm != NULL ? lhm->list : NULL;
+}
+
+
+/**
+ * @brief Returns the value of the entry held by a node of ll_lhm_list
+ */
+void*
+ll_lhm_value(ll_lhm_t *lhm, ll_node_t *ptr_node)
+{
+    if(lhm == NULL || ptr_node == NULL)
+        return NULL;
+    return (char*)_ll_node_payload(ptr_node) + lhm->value_offset;
+}
+
+
+static inline _ll_lhm_meta_t*
+_ll_lhm_meta(ll_lhm_t *lhm, ll_node_t *ptr_node)
+{
+    return (_ll_lhm_meta_t*)((char*)_ll_node_payload(ptr_node) + lhm->meta_offset);
+}
+
+
+/**
+ * @brief Migrates up to steps buckets of the old table to the new one,
+ * releasing the old table once it is empty
+ */
+static void
+_ll_lhm_rehash_step(ll_lhm_t *lhm, size_t steps)
+{
+    if(lhm->buckets[1] == NULL)
+        return;
+
+    while(steps-- > 0 && lhm->rehash <= lhm->mask[0])
+    {
+        ll_node_t *ptr_node = lhm->buckets[0][lhm->rehash];
+        while(ptr_node != NULL)
+        {
+            _ll_lhm_meta_t *meta = _ll_lhm_meta(lhm, ptr_node);
+            ll_node_t *ptr_next = meta->chain;
+            size_t b = meta->hash & lhm->mask[1];
+            meta->chain = lhm->buckets[1][b];
+            lhm->buckets[1][b] = ptr_node;
+            ptr_node = ptr_next;
+        }
+        lhm->buckets[0][lhm->rehash++] = NULL;
+    }
+
+    if(lhm->rehash > lhm->mask[0])
+    {
+        free(lhm->buckets[0]);
+        lhm->buckets[0] = lhm->buckets[1];
+        lhm->mask[0] = lhm->mask[1];
+        lhm->buckets[1] = NULL;
+        lhm->rehash = 0;
+    }
+}
+
+
+/**
+ * @brief Starts moving entries to a table twice as large. The old table has
+ * as many buckets as entries and every put migrates several of them, so
+ * the move completes before the new table needs to grow in turn.
+ */
+static void
+_ll_lhm_grow(ll_lhm_t *lhm)
+{
+    size_t nbuckets = 2*(lhm->mask[0] + 1);
+    lhm->buckets[1] = (ll_node_t**)calloc(nbuckets, sizeof(ll_node_t*));
+    if(lhm->buckets[1] == NULL)
+    {
+        /* Not fatal, chains just get longer */
+        perror("calloc");
+        return;
+    }
+    lhm->mask[1] = nbuckets - 1;
+    lhm->rehash = 0;
+}
+
+
+/**
+ * @brief Looks up key in both tables
+ * @param link Receives the chain pointer referencing the entry, may be NULL
+ * @return Node of the entry, NULL if missing
+ */
+static ll_node_t*
+_ll_lhm_find(ll_lhm_t *lhm, const void *key, uint64_t hash, ll_node_t ***link)
+{
+    for(int t = 0; t < 2 && lhm->buckets[t] != NULL; ++t)
+    {
+        ll_node_t **ptr_link = &lhm->buckets[t][hash & lhm->mask[t]];
+        while(*ptr_link != NULL)
+        {
+            _ll_lhm_meta_t *meta = _ll_lhm_meta(lhm, *ptr_link);
+            if(meta->hash == hash && memcmp(_ll_node_payload(*ptr_link), key, lhm->key_size) == 0)
+            {
+                if(link != NULL)
+                    *link = ptr_link;
+                return *ptr_link;
+            }
+            ptr_link = &meta->chain;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief Looks up key
+ * @return Pointer to the value, valid until the entry is deleted, NULL if
+ * key is missing
+ */
+void*
+ll_lhm_get(ll_lhm_t *lhm, const void *key)
+{
+    if(lhm == NULL || key == NULL)
+        return NULL;
+    ll_node_t *ptr_node = _ll_lhm_find(lhm, key, _ll_hash_key(key, lhm->key_size), NULL);
+    if(ptr_node == NULL)
+        return NULL;
+    return (char*)_ll_node_payload(ptr_node) + lhm->value_offset;
+}
+
+
+/**
+ * @brief Inserts key at the end of the iteration order, or updates its
+ * value in place if already present
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_lhm_put(ll_lhm_t *lhm, const void *key, const void *value)
+{
+    if(lhm == NULL || key == NULL || (value == NULL && lhm->value_size > 0))
+        return -1;
+
+    uint64_t hash = _ll_hash_key(key, lhm->key_size);
+    ll_node_t *ptr_node = _ll_lhm_find(lhm, key, hash, NULL);
+    if(ptr_node != NULL)
+    {
+        memcpy((char*)_ll_node_payload(ptr_node) + lhm->value_offset, value, lhm->value_size);
+        return 0;
+    }
+
+    if(lhm->buckets[1] == NULL && lhm->len > lhm->mask[0])
+        _ll_lhm_grow(lhm);
+    _ll_lhm_rehash_step(lhm, LLIST_LHM_REHASH_STEP);
+
+    ptr_node = _ll_node_new(lhm->list, NULL);
+    if(ptr_node == NULL)
+        return -1;
+    char *payload = (char*)_ll_node_payload(ptr_node);
+    memcpy(payload, key, lhm->key_size);
+    memcpy(payload + lhm->value_offset, value, lhm->value_size);
+
+    int t = lhm->buckets[1] != NULL;
+    _ll_lhm_meta_t *meta = _ll_lhm_meta(lhm, ptr_node);
+    meta->hash = hash;
+    meta->chain = lhm->buckets[t][hash & lhm->mask[t]];
+    lhm->buckets[t][hash & lhm->mask[t]] = ptr_node;
+
+    _ll_link_after(lhm->list, lhm->tail, ptr_node);
+    lhm->tail = ptr_node;
+    ++lhm->len;
+    return 0;
+}
+
+
+/**
+ * @brief Removes key from the map
+ * @return 0 if the key was removed, -1 if it was missing
+ */
+int
+ll_lhm_del(ll_lhm_t *lhm, const void *key)
+{
+    ll_node_t **link;
+
+    if(lhm == NULL || key == NULL)
+        return -1;
+
+    _ll_lhm_rehash_step(lhm, LLIST_LHM_REHASH_STEP);
+    ll_node_t *ptr_node = _ll_lhm_find(lhm, key, _ll_hash_key(key, lhm->key_size), &link);
+    if(ptr_node == NULL)
+        return -1;
+
+    *link = _ll_lhm_meta(lhm, ptr_node)->chain;
+    if(ptr_node == lhm->tail)
+        lhm->tail = ptr_node->prev;
+    _ll_unlink(lhm->list, ptr_node);
+    _ll_free_node(lhm->list, ptr_node);
+    --lhm->len;
+    return 0;
+}
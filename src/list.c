@@ -25,20 +25,136 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <libll/ll.h>
+#include "ll_internal.h"
 
 #define LLIST_PRINT_BUFF_SIZE             16
-#define LLIST_REALLOC_THRESHOLD           8
+/* Payloads up to this size are allocated together with their node */
+#define LLIST_INLINE_SIZE                 16
+/* LL_LAZY lists check every so many deletes whether their tombstones
+ * reached 1/LLIST_LAZY_RATIO of the live nodes, and compact if so */
+#define LLIST_LAZY_BATCH                  64
+#define LLIST_LAZY_RATIO                  4
+
+/* Stands as the previous node of tombstones, which are not linked */
+static ll_node_t _ll_tombstone;
+
+
+/**
+ * @brief Whether nodes of an unpooled list have small payloads, which
+ * follow the node and its data descriptor in the same block so that they
+ * share its cache line and cost no allocation of their own
+ */
+static inline int
+_ll_small_nodes(const ll_t *ptr_list)
+{
+    return ptr_list->pool == NULL && !(ptr_list->flags & (LL_VARIABLE | LL_SHARED)) &&
+           ptr_list->element_size <= LLIST_INLINE_SIZE;
+}
+
+
+/**
+ * @brief Allocates size bytes aligned as the payloads of the list
+ * @return Pointer to the block, NULL upon failure
+ */
+static void*
+_ll_alloc(const ll_t *ptr_list, size_t size)
+{
+    void *ptr;
+    if(ptr_list->align <= sizeof(max_align_t))
+    {
+        if((ptr = malloc(size)) == NULL)
+            perror("malloc");
+        return ptr;
+    }
+    int err = posix_memalign(&ptr, ptr_list->align, size);
+    if(err != 0)
+    {
+        fprintf(stderr, "posix_memalign: %s\n", strerror(err));
+        return NULL;
+    }
+    return ptr;
+}
+
+
+/**
+ * @brief Allocates a payload block of an LL_SHARED list, with a single
+ * reference
+ * @param payload Payload to copy, NULL to leave the payload uninitialized
+ * @return Pointer to the payload, NULL upon failure
+ */
+void*
+_ll_shared_new(ll_t *ptr_list, const void *payload)
+{
+    char *block = (char*)_ll_alloc(ptr_list, _ll_shared_offset(ptr_list) + _ll_payload_span(ptr_list));
+    if(block == NULL)
+        return NULL;
+    ((_ll_shared_t*)block)->refs = 1;
+    if(payload != NULL)
+        memcpy(block + _ll_shared_offset(ptr_list), payload, ptr_list->element_size);
+    return block + _ll_shared_offset(ptr_list);
+}
+
+
+/**
+ * @brief Drops a reference to a payload of an LL_SHARED list, freeing the
+ * block with the last one. References may be dropped concurrently by
+ * lists owned by different threads.
+ */
+void
+_ll_shared_release(ll_t *ptr_list, void *payload)
+{
+    _ll_shared_t *ptr_shared = (_ll_shared_t*)((char*)payload - _ll_shared_offset(ptr_list));
+    if(__atomic_sub_fetch(&ptr_shared->refs, 1, __ATOMIC_ACQ_REL) == 0)
+        free(ptr_shared);
+}
+
+
+/**
+ * @brief Padding before the header of variable size nodes, which aligns
+ * the payload following it
+ */
+static inline size_t
+_ll_var_pad(const ll_t *ptr_list)
+{
+    return _ll_round(sizeof(_ll_var_node_t), _ll_align(ptr_list)) - sizeof(_ll_var_node_t);
+}
 
 
 /**
  * @brief Frees a node and associated dynamically allocated memory
  */
 void 
-_ll_free_node(ll_node_t* ptr_node)
+_ll_free_node(ll_t* ptr_list, ll_node_t* ptr_node)
 {
     if(ptr_node == NULL) {
         return;
     }
+    if(ptr_list->pool != NULL)
+    {
+        if(ptr_list->cold != NULL)
+            _ll_pool_free(ptr_list->cold, ptr_node->data);
+        _ll_pool_free(ptr_list->pool, ptr_node);
+        return;
+    }
+    if(ptr_list->flags & LL_SHARED)
+    {
+        /* The data descriptor follows the node in the same block */
+        _ll_shared_release(ptr_list, ptr_node->data->payload);
+        free(ptr_node);
+        return;
+    }
+    if(ptr_list->flags & LL_VARIABLE)
+    {
+        if(ptr_list->strtab != NULL)
+            _ll_strtab_release(ptr_list->strtab, ptr_node->data->payload);
+        free((char*)ptr_node - _ll_var_pad(ptr_list));
+        return;
+    }
+    if(_ll_small_nodes(ptr_list))
+    {
+        free(ptr_node);
+        return;
+    }
     free(ptr_node->data->payload);
     free(ptr_node->data);
     free(ptr_node);
@@ -46,49 +162,413 @@ _ll_free_node(ll_node_t* ptr_node)
 
 
 /**
- * @brief Initializes a new list with a single root node
- * @param payload Payload of the root node
- * @param Size of each data element within the list
+ * @brief Allocates an unlinked node and copies the payload into it
+ *
+ * Nodes of pooled lists are carved from the list's slabs, with the data
+ * descriptor and the payload laid out right after the node, or coming from
+ * a pool of their own on LL_HOTCOLD lists. Small payloads of unpooled lists
+ * are laid out the same way, in a single allocation. Payloads are aligned
+ * as requested with ll_new_aligned.
+ * @param payload Payload to copy, NULL to leave the payload uninitialized
+ * @return Pointer to the new node, NULL upon failure
+ */
+ll_node_t*
+_ll_node_new(ll_t* ptr_list, const void *payload)
+{
+    ll_node_t *ptr_node;
+    ll_data_t *ptr_data;
+
+    if(ptr_list->flags & LL_VARIABLE)
+        return _ll_node_new_var(ptr_list, payload, ptr_list->element_size);
+    if(ptr_list->pool != NULL)
+    {
+        ptr_node = (ll_node_t*)_ll_pool_alloc(ptr_list->pool);
+        if(ptr_node == NULL)
+            return NULL;
+        if(ptr_list->cold != NULL)
+        {
+            ptr_data = (ll_data_t*)_ll_pool_alloc(ptr_list->cold);
+            if(ptr_data == NULL)
+            {
+                _ll_pool_free(ptr_list->pool, ptr_node);
+                return NULL;
+            }
+            ptr_data->payload = (char*)ptr_data + _ll_round(sizeof(ll_data_t), _ll_align(ptr_list));
+        }
+        else
+        {
+            ptr_data = (ll_data_t*)(ptr_node + 1);
+            ptr_data->payload = (char*)ptr_node + _ll_payload_offset(ptr_list);
+        }
+    }
+    else if(ptr_list->flags & LL_SHARED)
+    {
+        ptr_node = (ll_node_t*)malloc(sizeof(ll_node_t) + sizeof(ll_data_t));
+        if(ptr_node == NULL)
+        {
+            perror("malloc");
+            return NULL;
+        }
+        ptr_data = (ll_data_t*)(ptr_node + 1);
+        ptr_data->payload = _ll_shared_new(ptr_list, payload);
+        if(ptr_data->payload == NULL)
+        {
+            free(ptr_node);
+            return NULL;
+        }
+        /* Copied already */
+        payload = NULL;
+    }
+    else if(_ll_small_nodes(ptr_list))
+    {
+        ptr_node = (ll_node_t*)_ll_alloc(ptr_list, _ll_payload_offset(ptr_list) + _ll_payload_span(ptr_list));
+        if(ptr_node == NULL)
+            return NULL;
+        ptr_data = (ll_data_t*)(ptr_node + 1);
+        ptr_data->payload = (char*)ptr_node + _ll_payload_offset(ptr_list);
+    }
+    else
+    {
+        ptr_node = (ll_node_t*)malloc(sizeof(ll_node_t));
+        ptr_data = (ll_data_t*)malloc(sizeof(ll_data_t));
+        void *ptr_payload = _ll_alloc(ptr_list, _ll_payload_span(ptr_list));
+        if(ptr_node == NULL || ptr_data == NULL || ptr_payload == NULL)
+        {
+            perror("malloc");
+            free(ptr_payload);
+            free(ptr_data);
+            free(ptr_node);
+            return NULL;
+        }
+        ptr_data->payload = ptr_payload;
+    }
+
+    if(payload != NULL)
+        memcpy(ptr_data->payload, payload, ptr_list->element_size);
+    if(ptr_list->cold != NULL)
+        *_ll_fingerprint(ptr_node) = payload != NULL ? _ll_hash_key(payload, ptr_list->element_size) : 0;
+    ptr_node->data = ptr_data;
+    ptr_node->next = NULL;
+    ptr_node->prev = NULL;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Allocates an unlinked node of an LL_VARIABLE list, with its
+ * payload length and payload in the same block
+ * @param payload Payload to copy, NULL to leave the payload uninitialized
+ * @return Pointer to the new node, NULL upon failure
+ */
+ll_node_t*
+_ll_node_new_var(ll_t* ptr_list, const void *payload, size_t size)
+{
+    size_t pad = _ll_var_pad(ptr_list);
+    size_t span = _ll_round(size, _ll_align(ptr_list));
+    if(ptr_list->strtab != NULL)
+        span = 0;
+    else if(ptr_list->flags & LL_STRING)
+        span = _ll_round(size + 1, _ll_align(ptr_list));
+    char *block = (char*)_ll_alloc(ptr_list, pad + sizeof(_ll_var_node_t) + span);
+    if(block == NULL)
+        return NULL;
+    _ll_var_node_t *ptr_var = (_ll_var_node_t*)(block + pad);
+    ptr_var->size = size;
+    ptr_var->data.payload = ptr_var->payload;
+    if(ptr_list->flags & LL_STRING)
+    {
+        if(payload == NULL)
+            payload = "";
+        ptr_var->hash = _ll_hash_key(payload, size);
+        if(ptr_list->strtab != NULL)
+        {
+            /* The node only points to the shared copy of the string */
+            ptr_var->data.payload = (void*)_ll_strtab_intern(ptr_list->strtab, payload, size, ptr_var->hash);
+            if(ptr_var->data.payload == NULL)
+            {
+                free(block);
+                return NULL;
+            }
+        }
+        else
+        {
+            memcpy(ptr_var->payload, payload, size);
+            ((char*)ptr_var->payload)[size] = '\0';
+        }
+    }
+    else if(payload != NULL)
+        memcpy(ptr_var->payload, payload, size);
+    ptr_var->node.data = &ptr_var->data;
+    ptr_var->node.next = NULL;
+    ptr_var->node.prev = NULL;
+    return &ptr_var->node;
+}
+
+
+/**
+ * @brief Initializes the fields of an empty list, with no storage of its
+ * own. Lists embedded in other structures set their pool afterwards.
+ */
+void
+_ll_list_init(ll_t* ptr_list, size_t size, unsigned int flags, size_t align)
+{
+    ptr_list->root = NULL;
+    ptr_list->len = 0;
+    ptr_list->element_size = size;
+    ptr_list->pool = NULL;
+    ptr_list->flags = flags;
+    ptr_list->finger = NULL;
+    ptr_list->finger_pos = 0;
+    ptr_list->index = NULL;
+    ptr_list->cold = NULL;
+    ptr_list->align = align;
+    ptr_list->strtab = NULL;
+    ptr_list->tombs = NULL;
+    ptr_list->ntombs = 0;
+}
+
+
+/**
+ * @brief Creates an empty list
+ * @param size Size of each data element within the list
+ * @param flags LL_* flags, LL_POOLED to allocate nodes in bulk from slabs
+ * @return Pointer to the new list or NULL upon failure
  */
 ll_t*
-ll_init(void *payload, size_t size)
+_ll_new(size_t size, unsigned int flags)
 {
-    if(payload == NULL || size <= 0)
+    return ll_new_aligned(size, flags, 0);
+}
+
+
+/**
+ * @brief Creates an empty list whose payloads are aligned to align bytes
+ *
+ * Every storage path honors the alignment: separately allocated payloads,
+ * payloads sharing a block with their node and pooled ones. Each payload
+ * is also padded to a multiple of align, and the node header is kept out
+ * of the aligned blocks of the payload, so that with LL_CACHELINE no two
+ * payloads, nor a payload and a node, share a cache line.
+ * @param size Size of each data element within the list
+ * @param flags LL_* flags, as for ll_new
+ * @param align Power of two, 0 for the default alignment of malloc
+ * @return Pointer to the new list or NULL upon failure
+ */
+ll_t*
+ll_new_aligned(size_t size, unsigned int flags, size_t align)
+{
+    if(align & (align - 1))
+        return NULL;
+    if(flags & LL_STRING)
+        flags |= LL_VARIABLE;
+    /* Variable size nodes cannot be carved from fixed size slabs */
+    if(flags & LL_VARIABLE)
+    {
+        if(flags & (LL_POOLED | LL_INDEXED | LL_HASHED | LL_HOTCOLD))
+            return NULL;
+    }
+    else if(size == 0)
+        return NULL;
+    /* Index nodes are found from the payload, which must follow the node */
+    if((flags & LL_HOTCOLD) && (flags & (LL_INDEXED | LL_HASHED)))
+        return NULL;
+    /* Shared payloads outlive the slabs of any one list */
+    if((flags & LL_SHARED) &&
+       (flags & (LL_VARIABLE | LL_POOLED | LL_INDEXED | LL_HASHED | LL_HOTCOLD | LL_HUGEPAGES | LL_NUMA)))
         return NULL;
 
     ll_t* ptr_list = (ll_t*)malloc(sizeof(ll_t));
     if(ptr_list == NULL)
     {
-        perror("malloc:");
-        goto err_list;
+        perror("malloc");
+        return NULL;
     }
-    ptr_list->element_size = size;
-    ll_node_t* ptr_node = (ll_node_t*)malloc(sizeof(ll_node_t));
-    if(ptr_node == NULL)
+    if(flags & LL_HASHED)
+        flags |= LL_INDEXED;
+    if(flags & (LL_HUGEPAGES | LL_NUMA))
+        flags |= LL_POOLED;
+    _ll_list_init(ptr_list, size, flags, align);
+    if(flags & LL_HOTCOLD)
     {
-        perror("malloc:");
-        goto err_node;
+        /* Nodes and fingerprints are packed in the pool, payloads go cold */
+        ptr_list->pool = _ll_pool_new(sizeof(ll_node_t) + sizeof(uint64_t));
+        ptr_list->cold = _ll_pool_new_aligned(_ll_round(sizeof(ll_data_t), _ll_align(ptr_list)) +
+                                              _ll_payload_span(ptr_list), align);
+        if(ptr_list->pool == NULL || ptr_list->cold == NULL)
+        {
+            _ll_pool_destroy(ptr_list->pool);
+            _ll_pool_destroy(ptr_list->cold);
+            free(ptr_list);
+            return NULL;
+        }
+        ptr_list->flags |= LL_POOLED;
+        if(flags & LL_HUGEPAGES)
+        {
+            _ll_pool_use_hugepages(ptr_list->pool);
+            _ll_pool_use_hugepages(ptr_list->cold);
+        }
+        if((flags & LL_NUMA) &&
+           (_ll_pool_use_numa(ptr_list->pool) != 0 || _ll_pool_use_numa(ptr_list->cold) != 0))
+        {
+            ll_destroy(ptr_list);
+            return NULL;
+        }
+        return ptr_list;
     }
-    ll_data_t *ptr_data = (ll_data_t*)malloc(sizeof(ll_data_t));
-    if(ptr_data == NULL)
+    size = _ll_payload_span(ptr_list);
+    if(flags & LL_INDEXED)
     {
-        perror("malloc");
-        goto err_data;
+        /* Index nodes live right after the payload, in the same object */
+        flags |= LL_POOLED;
+        size += sizeof(_ll_osnode_t);
+        if(flags & LL_HASHED)
+            size += sizeof(_ll_oshash_t);
     }
-    void *ptr_payload = (void*)malloc(size);
-    if(ptr_payload == NULL)
+    if(flags & LL_POOLED)
     {
-        perror("malloc");
-        goto err_payload;
+        ptr_list->pool = _ll_pool_new_aligned(_ll_payload_offset(ptr_list) + size, align);
+        if(ptr_list->pool == NULL)
+        {
+            free(ptr_list);
+            return NULL;
+        }
+        if(flags & LL_HUGEPAGES)
+            _ll_pool_use_hugepages(ptr_list->pool);
+        if((flags & LL_NUMA) && _ll_pool_use_numa(ptr_list->pool) != 0)
+        {
+            ll_destroy(ptr_list);
+            return NULL;
+        }
     }
+    return ptr_list;
+}
 
-    memcpy(ptr_payload, (char *)payload, size);
 
-    ptr_data->payload = ptr_payload;
-    ptr_node->data = ptr_data;
+/**
+ * @brief Links an unlinked node right after pos, or at the head if pos is NULL
+ */
+void
+_ll_link_after(ll_t* ptr_list, ll_node_t* ptr_pos, ll_node_t* ptr_node)
+{
+    ptr_list->finger = NULL;
+    ++ptr_list->len;
+    if(ptr_list->flags & LL_INDEXED)
+        _ll_index_link(ptr_list, ptr_pos, ptr_node);
+    if(ptr_list->flags & LL_CIRCULAR)
+    {
+        if(ptr_list->root == NULL)
+        {
+            ptr_node->next = ptr_node;
+            ptr_node->prev = ptr_node;
+            ptr_list->root = ptr_node;
+            return;
+        }
+        /* A new head goes right after the last node */
+        ll_node_t *ptr_after = ptr_pos != NULL ? ptr_pos : ptr_list->root->prev;
+        ptr_node->prev = ptr_after;
+        ptr_node->next = ptr_after->next;
+        ptr_after->next->prev = ptr_node;
+        ptr_after->next = ptr_node;
+        if(ptr_pos == NULL)
+            ptr_list->root = ptr_node;
+        return;
+    }
+    if(ptr_pos == NULL)
+    {
+        ptr_node->prev = NULL;
+        ptr_node->next = ptr_list->root;
+        if(ptr_list->root != NULL)
+            ptr_list->root->prev = ptr_node;
+        ptr_list->root = ptr_node;
+        return;
+    }
+    ptr_node->prev = ptr_pos;
+    ptr_node->next = ptr_pos->next;
+    if(ptr_pos->next != NULL)
+        ptr_pos->next->prev = ptr_node;
+    ptr_pos->next = ptr_node;
+}
+
+
+/**
+ * @brief Detaches a node from the list without freeing it
+ */
+void
+_ll_unlink(ll_t* ptr_list, ll_node_t* ptr_node)
+{
+    ptr_list->finger = NULL;
+    --ptr_list->len;
+    if(ptr_list->flags & LL_INDEXED)
+        _ll_index_unlink(ptr_list, ptr_node);
+    if(ptr_list->flags & LL_CIRCULAR)
+    {
+        if(ptr_node->next == ptr_node)
+            ptr_list->root = NULL;
+        else if(ptr_list->root == ptr_node)
+            ptr_list->root = ptr_node->next;
+        ptr_node->prev->next = ptr_node->next;
+        ptr_node->next->prev = ptr_node->prev;
+        ptr_node->next = NULL;
+        ptr_node->prev = NULL;
+        return;
+    }
+    if(ptr_node->prev != NULL)
+        ptr_node->prev->next = ptr_node->next;
+    else
+        ptr_list->root = ptr_node->next;
+    if(ptr_node->next != NULL)
+        ptr_node->next->prev = ptr_node->prev;
     ptr_node->next = NULL;
     ptr_node->prev = NULL;
+}
+
+
+/**
+ * @brief Creates an empty list
+ * @param size Size of each data element within the list
+ * @param flags LL_POOLED to allocate nodes from slabs, which is required
+ * for ll_handle, LL_INDEXED for O(log n) ll_index_of, which implies
+ * LL_POOLED, LL_HASHED for O(1) ll_hash, which implies LL_INDEXED,
+ * LL_CIRCULAR for circular mode, LL_VARIABLE for payloads of different
+ * sizes, in which case size is the one used by ll_insert, ll_search and
+ * ll_del and may be 0, LL_HOTCOLD to keep payloads away from the nodes
+ * for search dominated workloads, LL_HUGEPAGES to back the slabs with
+ * huge pages and LL_NUMA to place them on NUMA nodes, which all imply
+ * LL_POOLED, LL_STRING for strings, which implies LL_VARIABLE, and
+ * LL_SHARED for payloads shared among lists, which cannot be pooled, and
+ * LL_LAZY to free deleted nodes in batches
+ * @return Pointer to the new list or NULL upon failure
+ */
+ll_t*
+ll_new(size_t size, unsigned int flags)
+{
+    return _ll_new(size, flags);
+}
+
+
+/**
+ * @brief Initializes a new list with a single root node
+ * @param payload Payload of the root node
+ * @param Size of each data element within the list
+ */
+ll_t*
+ll_init(void *payload, size_t size)
+{
+    if(payload == NULL || size <= 0)
+        return NULL;
+
+    ll_t* ptr_list = (ll_t*)malloc(sizeof(ll_t));
+    if(ptr_list == NULL)
+    {
+        perror("malloc:");
+        goto err_list;
+    }
+    _ll_list_init(ptr_list, size, 0, 0);
+    ll_node_t* ptr_node = _ll_node_new(ptr_list, payload);
+    if(ptr_node == NULL)
+        goto err_list;
     ptr_list->root = ptr_node;
+    ptr_list->len = 1;
 
     assert(ptr_node != NULL);
     assert(ptr_node->data != NULL);
@@ -98,67 +578,50 @@ ll_init(void *payload, size_t size)
 
     return ptr_list;
 
-err_payload:
-    free(ptr_payload); 
-err_data:
-    free(ptr_data);
-err_node:
-    free(ptr_node);
 err_list:
     free(ptr_list);
     return NULL;
 }
 
 
+/**
+ * @brief Prints the list by calling print on every payload
+ * @param print Callback which formats a payload into the buffer passed as
+ * second argument and returns the number of characters written, or -1
+ * @return Newly allocated string, NULL upon failure
+ */
 char*
 ll_print(ll_t *ptr_list, int (*print)(void*, char*))
 {
-    size_t curr_buff_size = LLIST_PRINT_BUFF_SIZE;
+    _ll_chunk_t chunk;
 
     if(ptr_list == NULL || print == NULL) {
         return NULL;
     }
 
-    char *buff = (char*)malloc(sizeof(char)*LLIST_PRINT_BUFF_SIZE);
-    if(buff == NULL) {
-	perror("malloc:");
-	goto free_buff;
-    }
-    memset(buff, 0, LLIST_PRINT_BUFF_SIZE);
+    if(_ll_chunk_init(&chunk, LLIST_PRINT_BUFF_SIZE) != 0)
+        return NULL;
 
     int written = 0;
-    size_t buff_ptr = 0;
     ll_node_t* root = ptr_list->root;
     while(root != NULL)
     {
-        written =  (*print)(root->data->payload, buff + buff_ptr);
+        /* Room is made before calling print, which has no bound to honour */
+        char *buff = _ll_chunk_reserve(&chunk, LLIST_FMT_MAX);
+        if(buff == NULL)
+            goto free_buff;
+
+        written =  (*print)(root->data->payload, buff);
         if(written == -1)
-        {
-            free(buff);
-            return NULL;
-        }
+            goto free_buff;
 
-        buff_ptr += written;
-        if(buff_ptr  > curr_buff_size - LLIST_REALLOC_THRESHOLD)
-        {
-            char *new_buff = (char*)realloc(buff, sizeof(char)*(curr_buff_size*2));
-            if(new_buff == NULL) 
-            {
-                /* Old buffer has not been freed */
-                free(buff); 
-                perror("realloc");
-                return NULL;
-            }
-            buff = new_buff;
-            memset(buff + buff_ptr, 0, curr_buff_size);
-            curr_buff_size = curr_buff_size*2;
-        }
-        root = root->next;
+        chunk.len += written;
+        root = _ll_next(ptr_list, root);
     }
-    return buff;
+    return chunk.buff;
 
 free_buff:
-    free(buff);
+    _ll_chunk_free(&chunk);
     return NULL;
 }
 
@@ -176,6 +639,15 @@ ll_destroy(ll_t *ptr_list)
     }
     ll_node_t* root = ptr_list->root;
 
+    if(ptr_list->pool != NULL)
+    {
+        /* Nodes live in the slabs, which are released all together */
+        _ll_pool_destroy(ptr_list->pool);
+        _ll_pool_destroy(ptr_list->cold);
+        free(ptr_list);
+        return;
+    }
+
     /* Free the list staring from root onwards */
     if(root != NULL && root->prev != NULL)
         root->prev->next = NULL;
@@ -183,31 +655,39 @@ ll_destroy(ll_t *ptr_list)
     while(root != NULL)
     {
         ll_node_t* next = root->next;
-        free(root->data->payload);
-        free(root->data);
-        free(root);
+        _ll_free_node(ptr_list, root);
         root = next;
     }
+    ll_compact(ptr_list);
+    ll_strtab_destroy(ptr_list->strtab);
     free(ptr_list);
 }
 
 /**
- * @brief Returns the size of the list
+ * @brief Reports the memory taken by the slabs of a pooled list, and
+ * whether LL_HUGEPAGES lists got huge pages. Unpooled lists report zeros.
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_stats(ll_t* ptr_list, ll_stats_t* stats)
+{
+    if(ptr_list == NULL || stats == NULL)
+        return -1;
+    memset(stats, 0, sizeof(ll_stats_t));
+    if(ptr_list->pool != NULL)
+        _ll_pool_stats(ptr_list->pool, stats);
+    if(ptr_list->cold != NULL)
+        _ll_pool_stats(ptr_list->cold, stats);
+    return 0;
+}
+
+/**
+ * @brief Returns the size of the list, in O(1)
  */
 size_t 
 ll_len(ll_t* ptr_list)
 {
-    size_t len = 0;
-    if(ptr_list == NULL)
-        return 0;
-
-    ll_node_t* root = ptr_list->root;
-    while(root != NULL)
-    {
-        ++len;
-        root = root->next;
-    }
-    return len;
+    return ptr_list != NULL ? ptr_list->len : 0;
 }
 
 /*
@@ -233,63 +713,92 @@ ll_insert(ll_t* ptr_list, void *payload, size_t pos)
         ptr_pos = ptr_pos-> next;
         --pos;
     }
-    ll_node_t *ptr_node = (ll_node_t*)malloc(sizeof(ll_node_t));
+    ll_node_t *ptr_node = _ll_node_new(ptr_list, payload);
     if(ptr_node == NULL)
+        return NULL;
+
+    /* A NULL ptr_prev links the node as the new root */
+    _ll_link_after(ptr_list, ptr_prev, ptr_node);
+    return ptr_list;
+}
+
+
+/**
+ * @brief Inserts a payload of len bytes in position pos of an LL_VARIABLE
+ * list. The node and the payload take a single allocation.
+ * @param pos Position, indexed from 0, where to add the new node
+ * @return Pointer to the list or NULL upon failure
+ */
+ll_t*
+ll_insert_var(ll_t* ptr_list, const void *payload, size_t len, size_t pos)
+{
+    if(ptr_list == NULL || !(ptr_list->flags & LL_VARIABLE) ||
+       (payload == NULL && len > 0) || pos > ll_len(ptr_list))
+        return NULL;
+
+    ll_node_t *ptr_node = _ll_node_new_var(ptr_list, payload, len);
+    if(ptr_node == NULL)
+        return NULL;
+    _ll_link_after(ptr_list, pos > 0 ? ll_node_get(ptr_list, pos - 1) : NULL, ptr_node);
+    return ptr_list;
+}
+
+
+/**
+ * @brief Returns the first node whose payload is len bytes long and
+ * matches payload, NULL if there is none
+ */
+static ll_node_t*
+_ll_search(ll_t* ptr_list, const void* payload, size_t len)
+{
+    ll_node_t* ptr_node = ptr_list->root;
+    /* Only whole payloads match, and fixed size payloads are that long */
+    if(!(ptr_list->flags & LL_VARIABLE) && len != ptr_list->element_size)
+        return NULL;
+    if(ptr_list->cold != NULL)
     {
-        perror("malloc");
-        goto err_node;
-    }
-    ll_data_t* ptr_data = (ll_data_t*)malloc(sizeof(ll_data_t));
-    if(ptr_data == NULL)
-    {
-        perror("malloc");
-        goto err_data;
-    }
-    ptr_data->payload = (void*)malloc(ptr_list->element_size);
-    if(ptr_data->payload == NULL)
-    
-    {
-        perror("malloc");
-        goto err_payload;
+        /* Payloads are only read when the fingerprint matches */
+        uint64_t fingerprint = _ll_hash_key(payload, len);
+        for(; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+        {
+            if(*_ll_fingerprint(ptr_node) == fingerprint &&
+               memcmp(ptr_node->data->payload, payload, len) == 0)
+                return ptr_node;
+        }
+        return NULL;
     }
-
-    if(ptr_pos == NULL) 
+    if(ptr_list->flags & LL_STRING)
     {
-        /* Appending at the end */
-        assert(ptr_node != NULL && ptr_prev != NULL);
-        ptr_node->next = NULL;
-        ptr_node->prev = ptr_prev;
-        ptr_prev->next = ptr_node;
+        if(payload == NULL)
+            payload = "";
+        uint64_t hash = _ll_hash_key(payload, len);
+        if(ptr_list->strtab != NULL)
+        {
+            /* Equal strings share their storage, compare addresses */
+            payload = _ll_strtab_find(ptr_list->strtab, payload, len, hash);
+            if(payload == NULL)
+                return NULL;
+            for(; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+                if(ptr_node->data->payload == payload)
+                    return ptr_node;
+            return NULL;
+        }
+        for(; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+        {
+            _ll_var_node_t *ptr_var = (_ll_var_node_t*)ptr_node;
+            if(ptr_var->hash == hash && ptr_var->size == len &&
+               memcmp(ptr_var->data.payload, payload, len) == 0)
+                return ptr_node;
+        }
+        return NULL;
     }
-    else if(ptr_pos->prev == NULL)
+    while(ptr_node != NULL)
     {
-        /* Beginning of the list */
-        assert(ptr_node != NULL && ptr_pos != NULL);
-        ptr_node->next = ptr_list->root;
-        ptr_node->prev = NULL;
-        ptr_pos->prev = ptr_node;
-        /* The node just allocated is the new root  */
-        ptr_list->root = ptr_node;
+        if(_ll_node_size(ptr_list, ptr_node) == len &&
+           (len == 0 || memcmp(ptr_node->data->payload, payload, len) == 0))
+            return ptr_node;
+        ptr_node = _ll_next(ptr_list, ptr_node);
     }
-    else
-    {  
-        /* Adding in the middle */ 
-        assert(ptr_node != NULL && ptr_pos != NULL && ptr_pos->prev != NULL);
-        ptr_node->next = ptr_pos;
-        ptr_node->prev = ptr_pos->prev;
-        ptr_pos->prev = ptr_node;
-        ptr_pos->prev->next = ptr_node;
-    }
-    memcpy(ptr_data->payload, (char *)payload, ptr_list->element_size);
-    ptr_node->data = ptr_data;
-    return ptr_list;
-
-err_payload:
-    free(ptr_node->data->payload);
-err_data:
-    free(ptr_node->data);
-err_node:
-    free(ptr_node);
     return NULL;
 }
 
@@ -306,53 +815,74 @@ ll_del(ll_t* ptr_list, void* payload)
         return NULL;
     }
 
-    ll_node_t *ptr_node = ptr_list->root;
-    while(ptr_node != NULL) 
+    ll_node_t *ptr_node = _ll_search(ptr_list, payload, ptr_list->element_size);
+    if(ptr_node != NULL)
+        ll_del_node(ptr_list, ptr_node);
+    return ptr_list;
+}
+
+
+/**
+ * @brief Deletes a node of the list in O(1), O(log n) on LL_INDEXED lists
+ *
+ * Nodes of LL_LAZY lists become tombstones: they are unlinked, so that no
+ * traversal meets them again and their handles go stale, but freeing them
+ * is left to ll_compact.
+ * @return 0 on success, -1 if the node was already deleted
+ */
+int
+ll_del_node(ll_t* ptr_list, ll_node_t* ptr_node)
+{
+    if(ptr_list == NULL || ptr_node == NULL || ptr_node->prev == &_ll_tombstone)
+        return -1;
+    _ll_unlink(ptr_list, ptr_node);
+    if(!(ptr_list->flags & LL_LAZY))
     {
-        if(memcmp(ptr_node->data->payload, payload, ptr_list->element_size) == 0)
-        {
-            if(ptr_node->prev == NULL)
-            {
-                /* First node of the list */
-                if(ptr_node->next != NULL)
-                {
-                   /* First node is followed by at least one more node */
-                   ptr_node->next->prev = NULL;
-                   ptr_list->root = ptr_node->next;
-                   _ll_free_node(ptr_node);
-                   return ptr_list;
-                }
-                else
-                {
-                    /* First node is the only one in the list */
-                    _ll_free_node(ptr_node);
-		    ptr_list->root = NULL;
-                    return ptr_list;
-                }
-            }
-            else
-            {
-                /* Node is not the first in the list */
-                if(ptr_node->next != NULL)
-                {
-                    /* Node is followed by at least one more node */
-                    ptr_node->next->prev = ptr_node->prev;
-                    ptr_node->prev->next = ptr_node->next;
-                    _ll_free_node(ptr_node);
-
-                }
-                else
-                { 
-                    /* Node is the last in the list */
-                    ptr_node->prev->next = NULL;
-                    _ll_free_node(ptr_node);
-                }
-                return ptr_list;
-            }
-        }
-        ptr_node = ptr_node->next;
+        _ll_free_node(ptr_list, ptr_node);
+        return 0;
     }
-    return ptr_list;
+    ptr_node->prev = &_ll_tombstone;
+    ptr_node->next = ptr_list->tombs;
+    ptr_list->tombs = ptr_node;
+    ++ptr_list->ntombs;
+    if(ptr_list->ntombs % LLIST_LAZY_BATCH == 0 &&
+       ptr_list->ntombs * LLIST_LAZY_RATIO >= ptr_list->len)
+        ll_compact(ptr_list);
+    return 0;
+}
+
+
+/**
+ * @brief Deletes the node a handle refers to, see ll_del_node
+ * @return 0 on success, -1 if the handle is stale
+ */
+int
+ll_del_handle(ll_t* ptr_list, ll_handle_t handle)
+{
+    return ll_del_node(ptr_list, ll_handle_node(ptr_list, handle));
+}
+
+
+/**
+ * @brief Frees all at once the tombstones of an LL_LAZY list
+ * @return Number of nodes freed
+ */
+size_t
+ll_compact(ll_t* ptr_list)
+{
+    if(ptr_list == NULL)
+        return 0;
+    size_t freed = ptr_list->ntombs;
+    ll_node_t *ptr_node = ptr_list->tombs;
+    while(ptr_node != NULL)
+    {
+        ll_node_t *ptr_next = ptr_node->next;
+        _ll_free_node(ptr_list, ptr_node);
+        ptr_node = ptr_next;
+    }
+    ptr_list->tombs = NULL;
+    ptr_list->ntombs = 0;
+    return freed;
 }
 
 
@@ -369,15 +899,22 @@ ll_search(ll_t* ptr_list, void* payload)
     if(ptr_list == NULL || payload == NULL) {
         return NULL;
     }
-    ll_node_t* ptr_root = ptr_list->root;
-    while(ptr_root != NULL)
-    {
-        if(memcmp(ptr_root->data->payload, payload, ptr_list->element_size) == 0)
-            return ptr_root;
-        else
-            ptr_root = ptr_root->next;
+    return _ll_search(ptr_list, payload, ptr_list->element_size);
+}
+
+
+/**
+ * @brief Returns a pointer to the first node whose payload is len bytes
+ * long and matches payload. On fixed size lists only len equal to the
+ * element size can match.
+ */
+ll_node_t*
+ll_search_var(ll_t* ptr_list, const void* payload, size_t len)
+{
+    if(ptr_list == NULL || (payload == NULL && len > 0)) {
+        return NULL;
     }
-    return NULL;   
+    return _ll_search(ptr_list, payload, len);
 }
 
 
@@ -396,6 +933,12 @@ ll_node_get(ll_t *ptr_list, size_t pos)
     ll_node_t* ptr_root = ptr_list->root;
     if(ptr_root == NULL || pos >= ll_len(ptr_list))
         return NULL;
+    if(ptr_list->flags & LL_INDEXED)
+    {
+        if(ptr_list->flags & LL_CIRCULAR)
+            pos = (pos + _ll_index_rank(ptr_list, ptr_root)) % ll_len(ptr_list);
+        return _ll_index_select(ptr_list, pos);
+    }
     while(pos > 0)
     {
         /* pos was checked against the length of the list, can't be null at this point */
@@ -422,10 +965,23 @@ ll_node_payload(ll_node_t* ptr_node)
         return ptr_node->data->payload;
 }
 
+/**
+ * @brief Returns the size of the payload of a node, which is the element
+ * size of the list unless the list is LL_VARIABLE
+ */
+size_t
+ll_node_size(ll_t* ptr_list, ll_node_t* ptr_node)
+{
+    if(ptr_list == NULL || ptr_node == NULL)
+        return 0;
+    return _ll_node_size(ptr_list, ptr_node);
+}
+
 /**
  * @brief Returns a pointer to the node which follows the one passed as paramter
  * @param ptr_node Pointer to the current node
- * @return Pointer to the next node, NULL if the node is last
+ * @return Pointer to the next node, NULL if the node is last. On circular
+ * lists the last node is followed by the root, so this never returns NULL.
  */
 ll_node_t*
 ll_node_next(ll_node_t* ptr_node)
@@ -439,7 +995,8 @@ ll_node_next(ll_node_t* ptr_node)
 /**
  * @brief Returns a pointer to the node which comes before the one passed as parameter
  * @param ptr_node Pointer to the current node
- * @return Pointer to the previous node, NULL if the node is the root
+ * @return Pointer to the previous node, NULL if the node is the root. On
+ * circular lists the root is preceded by the last node.
  */
 ll_node_t*
 ll_node_prev(ll_node_t* ptr_node)
@@ -449,3 +1006,181 @@ ll_node_prev(ll_node_t* ptr_node)
     else
         return ptr_node->prev;
 }
+
+
+/**
+ * @brief Switches a list to or from circular mode
+ *
+ * In circular mode the last node links to the root and back, so walking
+ * with ll_node_next never hits NULL. Functions taking the list still visit
+ * each node once. Turning the mode on walks the list to find the last node,
+ * turning it off is O(1), or O(log n) on LL_INDEXED lists whose index is
+ * brought back in line with the root after rotations.
+ * @param circular Non zero for circular mode
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_set_circular(ll_t* ptr_list, int circular)
+{
+    if(ptr_list == NULL)
+        return -1;
+    if(!circular == !(ptr_list->flags & LL_CIRCULAR))
+        return 0;
+
+    ll_node_t *ptr_root = ptr_list->root;
+    if(circular)
+    {
+        ptr_list->flags |= LL_CIRCULAR;
+        if(ptr_root == NULL)
+            return 0;
+        ll_node_t *ptr_last = ptr_root;
+        while(ptr_last->next != NULL)
+            ptr_last = ptr_last->next;
+        ptr_last->next = ptr_root;
+        ptr_root->prev = ptr_last;
+        return 0;
+    }
+
+    if(ptr_list->flags & LL_INDEXED)
+        _ll_index_reroot(ptr_list);
+    ptr_list->flags &= ~LL_CIRCULAR;
+    if(ptr_root != NULL)
+    {
+        ptr_root->prev->next = NULL;
+        ptr_root->prev = NULL;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Rotates a circular list by k positions without moving any node:
+ * the node k positions after the root, or -k positions before it for
+ * negative k, becomes the root
+ *
+ * k is reduced modulo the length first and the walk takes the shorter
+ * direction, so it costs O(min(k mod n, n - k mod n)).
+ * @return 0 on success, -1 if the list is not circular
+ */
+int
+ll_rotate(ll_t* ptr_list, long k)
+{
+    if(ptr_list == NULL || !(ptr_list->flags & LL_CIRCULAR))
+        return -1;
+    if(ptr_list->root == NULL)
+        return 0;
+
+    size_t len = ptr_list->len;
+    size_t steps = k >= 0 ? (size_t)k % len : (len - (-(size_t)k) % len) % len;
+    ll_node_t *ptr_node = ptr_list->root;
+
+    if(steps <= len / 2)
+    {
+        for(; steps > 0; --steps)
+            ptr_node = ptr_node->next;
+    }
+    else
+    {
+        for(steps = len - steps; steps > 0; --steps)
+            ptr_node = ptr_node->prev;
+    }
+    ptr_list->root = ptr_node;
+    ptr_list->finger = NULL;
+    return 0;
+}
+
+
+/**
+ * @brief Round-robin iteration over a circular list: returns the root and
+ * makes the following node the new root, in O(1)
+ * @return The node, NULL if the list is empty or not circular
+ */
+ll_node_t*
+ll_rr_next(ll_t* ptr_list)
+{
+    if(ptr_list == NULL || !(ptr_list->flags & LL_CIRCULAR) || ptr_list->root == NULL)
+        return NULL;
+    ll_node_t *ptr_node = ptr_list->root;
+    ptr_list->root = ptr_node->next;
+    ptr_list->finger = NULL;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Returns a handle to a node of a pooled list. Unlike the node
+ * pointer, the handle can be checked for staleness once the node is
+ * deleted, see ll_handle_node.
+ * @return The handle, which never validates if the list is not pooled
+ */
+ll_handle_t
+ll_handle(ll_t* ptr_list, ll_node_t* ptr_node)
+{
+    ll_handle_t handle = {0, 0};
+    if(ptr_list == NULL || ptr_list->pool == NULL || ptr_node == NULL)
+        return handle;
+    return _ll_pool_handle(ptr_list->pool, ptr_node);
+}
+
+
+/**
+ * @brief Resolves a handle in O(1)
+ * @return The node, NULL if it has been deleted since the handle was taken
+ */
+ll_node_t*
+ll_handle_node(ll_t* ptr_list, ll_handle_t handle)
+{
+    if(ptr_list == NULL || ptr_list->pool == NULL)
+        return NULL;
+    ll_node_t *ptr_node = (ll_node_t*)_ll_pool_lookup(ptr_list->pool, handle);
+    if(ptr_node != NULL && ptr_node->prev == &_ll_tombstone)
+        return NULL;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Returns the position of a node of the list, counted from the root
+ *
+ * Takes O(log n) on LL_INDEXED lists. Other lists walk back from the node
+ * to the root, or to the node of the previous call if met first, so that
+ * queries of increasing positions with no modification in between only
+ * walk the distance between them.
+ * @return Position of the node, -1 upon failure
+ */
+ssize_t
+ll_index_of(ll_t* ptr_list, ll_node_t* ptr_node)
+{
+    if(ptr_list == NULL || ptr_node == NULL || ptr_list->root == NULL)
+        return -1;
+
+    if(ptr_list->flags & LL_INDEXED)
+    {
+        size_t pos = _ll_index_rank(ptr_list, ptr_node);
+        if(ptr_list->flags & LL_CIRCULAR)
+        {
+            /* The root is not necessarily the first node of the index */
+            size_t len = ((_ll_osnode_t*)ptr_list->index)->size;
+            pos = (pos + len - _ll_index_rank(ptr_list, ptr_list->root)) % len;
+        }
+        return pos;
+    }
+
+    size_t pos = 0;
+    ll_node_t *ptr_cur = ptr_node;
+    while(ptr_cur != ptr_list->root)
+    {
+        if(ptr_cur == ptr_list->finger)
+        {
+            pos += ptr_list->finger_pos;
+            break;
+        }
+        ptr_cur = ptr_cur->prev;
+        if(ptr_cur == NULL)
+            return -1;
+        ++pos;
+    }
+    ptr_list->finger = ptr_node;
+    ptr_list->finger_pos = pos;
+    return pos;
+}
@@ -0,0 +1,237 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LL_INTERNAL_H__
+#define __LL_INTERNAL_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <libll/ll.h>
+
+#define LLIST_CHUNK_SIZE                  4096
+
+/* Longest output of a single built-in formatted element, separator included */
+#define LLIST_FMT_MAX                     352
+
+/* Output buffer which grows in place as formatted elements are appended,
+ * or is flushed to fd when bound to a file descriptor */
+typedef struct {
+    char *buff;
+    size_t len;
+    size_t size;
+    int fd;
+    size_t flushed;
+} _ll_chunk_t;
+
+int _ll_chunk_init(_ll_chunk_t *chunk, size_t size);
+int _ll_chunk_init_fd(_ll_chunk_t *chunk, size_t size, int fd);
+char* _ll_chunk_reserve(_ll_chunk_t *chunk, size_t len);
+int _ll_chunk_flush(_ll_chunk_t *chunk);
+void _ll_chunk_free(_ll_chunk_t *chunk);
+
+size_t _ll_fmt_u64(char *dst, uint64_t value);
+size_t _ll_fmt_i64(char *dst, int64_t value);
+size_t _ll_fmt_double(char *dst, double value);
+size_t _ll_fmt_hex(char *dst, const void *bytes, size_t len);
+int _ll_fmt_width(ll_fmt_t fmt, size_t element_size);
+size_t _ll_fmt_len(ll_fmt_t fmt, const void *payload, size_t size);
+size_t _ll_fmt_value(char *dst, ll_fmt_t fmt, const void *payload, size_t size);
+int _ll_fmt_payload(_ll_chunk_t *chunk, ll_fmt_t fmt, const void *payload, size_t size);
+
+int _ll_writev_all(int fd, struct iovec *iov, int iovcnt);
+
+/* Same as ll_node_payload, for the hot paths of the library */
+static inline void*
+_ll_node_payload(ll_node_t *ptr_node)
+{
+    return ptr_node->data->payload;
+}
+
+/* Node of LL_VARIABLE lists, allocated at once with the length of the
+ * payload and the payload itself */
+typedef struct {
+    ll_node_t node;
+    ll_data_t data;
+    size_t size;
+    /* Hash of the payload on LL_STRING lists */
+    uint64_t hash;
+    max_align_t payload[];
+} _ll_var_node_t;
+
+/* Size of the payload of a node, which varies on LL_VARIABLE lists */
+static inline size_t
+_ll_node_size(const ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    if(ptr_list->flags & LL_VARIABLE)
+        return ((_ll_var_node_t*)ptr_node)->size;
+    return ptr_list->element_size;
+}
+
+static inline size_t
+_ll_round(size_t size, size_t align)
+{
+    return (size + align - 1) & ~(align - 1);
+}
+
+/* Alignment of the payloads of a list, at least 8 bytes */
+static inline size_t
+_ll_align(const ll_t *ptr_list)
+{
+    return ptr_list->align > 8 ? ptr_list->align : 8;
+}
+
+/* Room taken by a payload, padded to its alignment so that with
+ * ll_new_aligned nothing else is stored in the same aligned block */
+static inline size_t
+_ll_payload_span(const ll_t *ptr_list)
+{
+    return _ll_round(ptr_list->element_size, _ll_align(ptr_list));
+}
+
+/* Offset of the payload from its node when both share an allocation */
+static inline size_t
+_ll_payload_offset(const ll_t *ptr_list)
+{
+    return _ll_round(sizeof(ll_node_t) + sizeof(ll_data_t), _ll_align(ptr_list));
+}
+
+/* Header of the payloads of LL_SHARED lists */
+typedef struct {
+    size_t refs;
+    max_align_t payload[];
+} _ll_shared_t;
+
+/* Offset of the payload from the header of shared payload blocks */
+static inline size_t
+_ll_shared_offset(const ll_t *ptr_list)
+{
+    return _ll_round(sizeof(_ll_shared_t), _ll_align(ptr_list));
+}
+
+/* Fingerprint of the payload, following each node of LL_HOTCOLD lists */
+static inline uint64_t*
+_ll_fingerprint(ll_node_t *ptr_node)
+{
+    return (uint64_t*)(ptr_node + 1);
+}
+
+/* Node after ptr_node, NULL past the last one also for circular lists */
+static inline ll_node_t*
+_ll_next(const ll_t *ptr_list, const ll_node_t *ptr_node)
+{
+    return ptr_node->next != ptr_list->root ? ptr_node->next : NULL;
+}
+
+ll_t* _ll_new(size_t size, unsigned int flags);
+void _ll_list_init(ll_t *ptr_list, size_t size, unsigned int flags, size_t align);
+ll_node_t* _ll_node_new(ll_t *ptr_list, const void *payload);
+ll_node_t* _ll_node_new_var(ll_t *ptr_list, const void *payload, size_t size);
+void _ll_free_node(ll_t *ptr_list, ll_node_t *ptr_node);
+void _ll_link_after(ll_t *ptr_list, ll_node_t *ptr_pos, ll_node_t *ptr_node);
+void _ll_unlink(ll_t *ptr_list, ll_node_t *ptr_node);
+
+/* Node of the order statistic index, an implicit treap laid out after the
+ * payload of each node of LL_INDEXED lists */
+typedef struct _ll_osnode_t {
+    struct _ll_osnode_t *left;
+    struct _ll_osnode_t *right;
+    struct _ll_osnode_t *parent;
+    uint32_t size;
+    uint32_t priority;
+} _ll_osnode_t;
+
+static inline _ll_osnode_t*
+_ll_osnode(const ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    return (_ll_osnode_t*)((char*)ptr_node->data->payload + _ll_payload_span(ptr_list));
+}
+
+/* Content hash of a subtree, following the index node on LL_HASHED lists */
+typedef struct {
+    uint64_t self;
+    uint64_t hash;
+    uint64_t pow;
+} _ll_oshash_t;
+
+/* Base of the polynomial content hash, see ll_hash */
+#define LLIST_HASH_BASE                   0x100000001b3ULL
+
+uint64_t _ll_hash_element(const void *payload, size_t size);
+
+void _ll_index_link(ll_t *ptr_list, ll_node_t *ptr_pos, ll_node_t *ptr_node);
+void _ll_index_unlink(ll_t *ptr_list, ll_node_t *ptr_node);
+size_t _ll_index_rank(ll_t *ptr_list, ll_node_t *ptr_node);
+ll_node_t* _ll_index_select(ll_t *ptr_list, size_t pos);
+void _ll_index_refresh(ll_t *ptr_list, ll_node_t *ptr_node);
+void _ll_index_reroot(ll_t *ptr_list);
+
+uint64_t _ll_hash_bytes(const void *data, size_t len, uint64_t seed);
+
+/* Hashes a fixed size key. Keys of up to eight bytes, the common case, are
+ * mixed as a single word instead of going through the generic hash. */
+static inline uint64_t
+_ll_hash_key(const void *key, size_t size)
+{
+    uint64_t h = 0;
+    if(size > sizeof(h))
+        return _ll_hash_bytes(key, size, 0);
+    memcpy(&h, key, size);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+void* _ll_shared_new(ll_t *ptr_list, const void *payload);
+void _ll_shared_release(ll_t *ptr_list, void *payload);
+
+const char* _ll_strtab_intern(ll_strtab_t *strtab, const void *str, size_t len, uint64_t hash);
+const char* _ll_strtab_find(ll_strtab_t *strtab, const void *str, size_t len, uint64_t hash);
+void _ll_strtab_release(ll_strtab_t *strtab, const void *str);
+
+/* Highest number of NUMA nodes LL_NUMA lists can place memory on */
+#define LLIST_NUMA_MAX_NODES              64
+
+int _ll_numa_bind(void *addr, size_t len, int node, int move);
+int _ll_numa_current(void);
+
+ll_pool_t* _ll_pool_new(size_t obj_size);
+ll_pool_t* _ll_pool_new_aligned(size_t obj_size, size_t align);
+ll_pool_t* _ll_pool_new_untagged(size_t obj_size, size_t align);
+void* _ll_pool_alloc(ll_pool_t *pool);
+void _ll_pool_free(ll_pool_t *pool, void *obj);
+ll_handle_t _ll_pool_handle(ll_pool_t *pool, void *obj);
+void* _ll_pool_lookup(ll_pool_t *pool, ll_handle_t handle);
+int _ll_pool_merge(ll_pool_t *dst, ll_pool_t *src);
+int _ll_pool_use_hugepages(ll_pool_t *pool);
+int _ll_pool_use_numa(ll_pool_t *pool);
+void _ll_pool_set_node(ll_pool_t *pool, int node);
+int _ll_pool_migrate(ll_pool_t *pool, int node);
+void _ll_pool_stats(ll_pool_t *pool, ll_stats_t *stats);
+void _ll_pool_destroy(ll_pool_t *pool);
+
+#endif
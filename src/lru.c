@@ -0,0 +1,355 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/lru.h>
+#include "ll_internal.h"
+
+#define LLIST_LRU_BATCH                   16
+
+/* Index slot, the hash is kept to avoid touching nodes of other keys */
+typedef struct {
+    uint64_t hash;
+    ll_node_t *node;
+} _ll_lru_slot_t;
+
+struct ll_lru_t_internal {
+    ll_t *list;
+    ll_node_t *tail;
+    size_t key_size;
+    size_t value_size;
+    size_t value_offset;
+    size_t capacity;
+    size_t len;
+    _ll_lru_slot_t *slots;
+    size_t mask;
+    ll_lru_evict_t evict;
+    void *ctx;
+};
+
+
+/**
+ * @brief Creates a cache holding up to capacity entries
+ *
+ * Entries are nodes of a list ordered from the most to the least recently
+ * used, whose payload is the key followed by the value. An open addressing
+ * index maps keys to nodes, so lookups, promotions and evictions are O(1).
+ * @param evict Callback invoked on entries evicted by ll_lru_put, may be NULL
+ * @param ctx Passed to evict
+ * @return Pointer to the cache, NULL upon failure
+ */
+ll_lru_t*
+ll_lru_new(size_t key_size, size_t value_size, size_t capacity, ll_lru_evict_t evict, void *ctx)
+{
+    if(key_size == 0 || capacity == 0)
+        return NULL;
+
+    ll_lru_t *lru = (ll_lru_t*)calloc(1, sizeof(ll_lru_t));
+    if(lru == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    lru->key_size = key_size;
+    lru->value_size = value_size;
+    lru->value_offset = (key_size + 7) & ~(size_t)7;
+    lru->capacity = capacity;
+    lru->evict = evict;
+    lru->ctx = ctx;
+
+    /* Keep the load factor of the index at or below one half */
+    size_t nslots = 8;
+    while(nslots < 2*capacity)
+        nslots *= 2;
+    lru->mask = nslots - 1;
+    lru->slots = (_ll_lru_slot_t*)calloc(nslots, sizeof(_ll_lru_slot_t));
+    lru->list = _ll_new(lru->value_offset + value_size, LL_POOLED);
+    if(lru->slots == NULL || lru->list == NULL)
+    {
+        perror("calloc");
+        ll_lru_destroy(lru);
+        return NULL;
+    }
+    return lru;
+}
+
+
+void
+ll_lru_destroy(ll_lru_t *lru)
+{
+    if(lru == NULL)
+        return;
+    ll_destroy(lru->list);
+    free(lru->slots);
+    free(lru);
+}
+
+
+size_t
+ll_lru_len(ll_lru_t *lru)
+{
+    return lru != NULL ? lru->len : 0;
+}
+
+
+/**
+ * @brief Returns the list of entries, most recently used first. The list
+ * must not be modified.
+ */
+ll_t*
+ll_lru_list(ll_lru_t *lru)
+{
+    return lru != NULL ? lru->list : NULL;
+}
+
+
+/**
+ * @brief Returns the index of the slot holding key, or of the empty slot
+ * which ends its probe sequence
+ */
+static size_t
+_ll_lru_find(ll_lru_t *lru, const void *key, uint64_t hash)
+{
+    size_t i = hash & lru->mask;
+    while(lru->slots[i].node != NULL)
+    {
+        if(lru->slots[i].hash == hash &&
+           memcmp(_ll_node_payload(lru->slots[i].node), key, lru->key_size) == 0)
+            return i;
+        i = (i + 1) & lru->mask;
+    }
+    return i;
+}
+
+
+/**
+ * @brief Empties slot i, shifting back the entries of the probe sequence
+ * so that no tombstone is needed
+ */
+static void
+_ll_lru_slot_del(ll_lru_t *lru, size_t i)
+{
+    size_t j = i;
+    for(;;)
+    {
+        lru->slots[i].node = NULL;
+        for(;;)
+        {
+            j = (j + 1) & lru->mask;
+            if(lru->slots[j].node == NULL)
+                return;
+            size_t home = lru->slots[j].hash & lru->mask;
+            /* Move j to i unless its home lies cyclically in (i, j] */
+            if(i <= j ? (home <= i || home > j) : (home <= i && home > j))
+                break;
+        }
+        lru->slots[i] = lru->slots[j];
+        i = j;
+    }
+}
+
+
+/**
+ * @brief Moves an entry to the most recently used position
+ */
+void
+ll_lru_touch(ll_lru_t *lru, ll_node_t *ptr_node)
+{
+    if(lru == NULL || ptr_node == NULL || ptr_node == lru->list->root)
+        return;
+    if(ptr_node == lru->tail)
+        lru->tail = ptr_node->prev;
+    _ll_unlink(lru->list, ptr_node);
+    _ll_link_after(lru->list, NULL, ptr_node);
+}
+
+
+/**
+ * @brief Looks up the node of key, without changing its position
+ * @return Node handle which can be passed to ll_lru_touch, NULL if missing
+ */
+ll_node_t*
+ll_lru_node(ll_lru_t *lru, const void *key)
+{
+    if(lru == NULL || key == NULL)
+        return NULL;
+    uint64_t hash = _ll_hash_key(key, lru->key_size);
+    return lru->slots[_ll_lru_find(lru, key, hash)].node;
+}
+
+
+/**
+ * @brief Looks up key and marks it as the most recently used entry
+ * @return Pointer to the value, valid until the entry is evicted or
+ * deleted, NULL if key is not cached
+ */
+void*
+ll_lru_get(ll_lru_t *lru, const void *key)
+{
+    ll_node_t *ptr_node = ll_lru_node(lru, key);
+    if(ptr_node == NULL)
+        return NULL;
+    ll_lru_touch(lru, ptr_node);
+    return (char*)_ll_node_payload(ptr_node) + lru->value_offset;
+}
+
+
+/**
+ * @brief Looks up n keys stored back to back
+ *
+ * Keys are processed in groups: all the hashes of a group are computed and
+ * their index slots prefetched before any of them is probed, so the cache
+ * misses of the group overlap. Hits are promoted in key order.
+ * @param values Receives a pointer to each value, NULL for missing keys
+ * @return Number of keys found
+ */
+size_t
+ll_lru_get_batch(ll_lru_t *lru, const void *keys, size_t n, void **values)
+{
+    uint64_t hashes[LLIST_LRU_BATCH];
+    ll_node_t *nodes[LLIST_LRU_BATCH];
+    size_t hits = 0;
+
+    if(lru == NULL || keys == NULL || values == NULL)
+        return 0;
+
+    for(size_t base = 0; base < n; base += LLIST_LRU_BATCH)
+    {
+        size_t count = n - base < LLIST_LRU_BATCH ? n - base : LLIST_LRU_BATCH;
+        const char *key = (const char*)keys + base*lru->key_size;
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            hashes[i] = _ll_hash_key(key + i*lru->key_size, lru->key_size);
+            __builtin_prefetch(&lru->slots[hashes[i] & lru->mask]);
+        }
+        for(size_t i = 0; i < count; ++i)
+        {
+            nodes[i] = lru->slots[_ll_lru_find(lru, key + i*lru->key_size, hashes[i])].node;
+            if(nodes[i] != NULL)
+                __builtin_prefetch(nodes[i]);
+        }
+        for(size_t i = 0; i < count; ++i)
+        {
+            values[base + i] = NULL;
+            if(nodes[i] == NULL)
+                continue;
+            ll_lru_touch(lru, nodes[i]);
+            values[base + i] = (char*)_ll_node_payload(nodes[i]) + lru->value_offset;
+            ++hits;
+        }
+    }
+    return hits;
+}
+
+
+/**
+ * @brief Removes the least recently used entry, calling the evict callback
+ * @return The node of the entry, detached from the list but not freed
+ */
+static ll_node_t*
+_ll_lru_evict(ll_lru_t *lru)
+{
+    ll_node_t *ptr_node = lru->tail;
+    char *payload = (char*)_ll_node_payload(ptr_node);
+
+    if(lru->evict != NULL)
+        lru->evict(payload, payload + lru->value_offset, lru->ctx);
+    uint64_t hash = _ll_hash_key(payload, lru->key_size);
+    _ll_lru_slot_del(lru, _ll_lru_find(lru, payload, hash));
+    lru->tail = ptr_node->prev;
+    _ll_unlink(lru->list, ptr_node);
+    --lru->len;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Inserts or updates key, which becomes the most recently used
+ * entry. When the cache is full the least recently used entry is evicted
+ * and its node reused, so a full cache never allocates.
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_lru_put(ll_lru_t *lru, const void *key, const void *value)
+{
+    if(lru == NULL || key == NULL || (value == NULL && lru->value_size > 0))
+        return -1;
+
+    uint64_t hash = _ll_hash_key(key, lru->key_size);
+    size_t i = _ll_lru_find(lru, key, hash);
+    ll_node_t *ptr_node = lru->slots[i].node;
+    if(ptr_node != NULL)
+    {
+        memcpy((char*)_ll_node_payload(ptr_node) + lru->value_offset, value, lru->value_size);
+        ll_lru_touch(lru, ptr_node);
+        return 0;
+    }
+
+    if(lru->len == lru->capacity)
+    {
+        ptr_node = _ll_lru_evict(lru);
+        /* Backward shifts may have moved the empty slot */
+        i = _ll_lru_find(lru, key, hash);
+    }
+    else if((ptr_node = _ll_node_new(lru->list, NULL)) == NULL)
+        return -1;
+    char *payload = (char*)_ll_node_payload(ptr_node);
+    memcpy(payload, key, lru->key_size);
+    memcpy(payload + lru->value_offset, value, lru->value_size);
+
+    _ll_link_after(lru->list, NULL, ptr_node);
+    if(lru->tail == NULL)
+        lru->tail = ptr_node;
+    lru->slots[i].hash = hash;
+    lru->slots[i].node = ptr_node;
+    ++lru->len;
+    return 0;
+}
+
+
+/**
+ * @brief Removes key from the cache, without calling the evict callback
+ * @return 0 if the key was removed, -1 if it was not cached
+ */
+int
+ll_lru_del(ll_lru_t *lru, const void *key)
+{
+    if(lru == NULL || key == NULL)
+        return -1;
+
+    uint64_t hash = _ll_hash_key(key, lru->key_size);
+    size_t i = _ll_lru_find(lru, key, hash);
+    ll_node_t *ptr_node = lru->slots[i].node;
+    if(ptr_node == NULL)
+        return -1;
+
+    _ll_lru_slot_del(lru, i);
+    if(ptr_node == lru->tail)
+        lru->tail = ptr_node->prev;
+    _ll_unlink(lru->list, ptr_node);
+    _ll_free_node(lru->list, ptr_node);
+    --lru->len;
+    return 0;
+}
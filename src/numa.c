@@ -0,0 +1,144 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+/* From the kernel uapi, so that libnuma is not needed */
+#define LLIST_MPOL_PREFERRED              1
+#define LLIST_MPOL_MF_MOVE                (1 << 1)
+#define LLIST_MPOL_F_NODE                 (1 << 0)
+#define LLIST_MPOL_F_ADDR                 (1 << 1)
+#define LLIST_MPOL_F_MEMS_ALLOWED         (1 << 2)
+
+/* The kernel reads one bit less than the maxnode it is passed */
+#define LLIST_NUMA_MAXNODE                (LLIST_NUMA_MAX_NODES + 1)
+
+
+/**
+ * @brief Sets the policy of a page aligned range to prefer a node
+ * @param move Non zero to also migrate the pages already in the range
+ * @return 0 on success, -1 upon failure
+ */
+int
+_ll_numa_bind(void *addr, size_t len, int node, int move)
+{
+    if(node < 0 || node >= LLIST_NUMA_MAX_NODES)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    unsigned long mask = 1UL << node;
+    return (int)syscall(SYS_mbind, addr, len, LLIST_MPOL_PREFERRED, &mask, LLIST_NUMA_MAXNODE,
+                        move ? LLIST_MPOL_MF_MOVE : 0);
+}
+
+
+/**
+ * @brief Returns the node of the CPU the calling thread runs on, -1 if
+ * unknown. glibc answers from the vDSO, without entering the kernel.
+ */
+int
+_ll_numa_current(void)
+{
+    unsigned int cpu, node;
+    if(getcpu(&cpu, &node) != 0)
+        return -1;
+    return (int)node;
+}
+
+
+/**
+ * @brief Whether the calling thread is allowed to place memory on a node
+ */
+static int
+_ll_numa_allowed(int node)
+{
+    unsigned long mask = 0;
+    if(node < 0 || node >= LLIST_NUMA_MAX_NODES)
+        return 0;
+    if(syscall(SYS_get_mempolicy, NULL, &mask, LLIST_NUMA_MAXNODE, NULL, LLIST_MPOL_F_MEMS_ALLOWED) != 0)
+        return 0;
+    return (mask >> node) & 1;
+}
+
+
+/**
+ * @brief Sets the NUMA node the slabs of an LL_NUMA list are taken from
+ *
+ * By default each node of the list is allocated on the NUMA node of the
+ * thread allocating it, from slabs of that node.
+ * @param node Preferred node, -1 to go back to the default
+ * @return 0 on success, -1 if the list is not LL_NUMA or node is invalid
+ */
+int
+ll_numa_set_node(ll_t* ptr_list, int node)
+{
+    if(ptr_list == NULL || !(ptr_list->flags & LL_NUMA) || (node != -1 && !_ll_numa_allowed(node)))
+        return -1;
+    _ll_pool_set_node(ptr_list->pool, node);
+    if(ptr_list->cold != NULL)
+        _ll_pool_set_node(ptr_list->cold, node);
+    return 0;
+}
+
+
+/**
+ * @brief Moves every node of an LL_NUMA list, with its payload, to a NUMA
+ * node, which also becomes the preferred node of the list
+ *
+ * Pages are migrated by the kernel, node addresses do not change. Nodes
+ * already freed move along with the slabs holding them, and are the first
+ * reused by later inserts, wherever the inserting thread runs.
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_numa_migrate(ll_t* ptr_list, int node)
+{
+    if(ptr_list == NULL || !(ptr_list->flags & LL_NUMA) || !_ll_numa_allowed(node))
+        return -1;
+    if(_ll_pool_migrate(ptr_list->pool, node) != 0)
+        return -1;
+    if(ptr_list->cold != NULL && _ll_pool_migrate(ptr_list->cold, node) != 0)
+        return -1;
+    return 0;
+}
+
+
+/**
+ * @brief Returns the NUMA node holding the memory of a node, -1 if unknown
+ */
+int
+ll_numa_node_of(ll_node_t* ptr_node)
+{
+    int node;
+    if(ptr_node == NULL)
+        return -1;
+    if(syscall(SYS_get_mempolicy, &node, NULL, 0, ptr_node, LLIST_MPOL_F_NODE | LLIST_MPOL_F_ADDR) != 0)
+        return -1;
+    return node;
+}
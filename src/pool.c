@@ -0,0 +1,656 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+#define LLIST_POOL_SLAB_SIZE              65536
+#define LLIST_POOL_MIN_OBJECTS            64
+/* Size of the slabs of pools backed by huge pages */
+#define LLIST_POOL_HUGE_SIZE              (2UL << 20)
+/* Allocations of LL_NUMA pools between two lookups of the current node */
+#define LLIST_POOL_NODE_REFRESH           64
+
+/* Slabs are chained through this header, objects follow it */
+typedef struct _ll_slab_t {
+    struct _ll_slab_t *next;
+    /* Length of the mapping of slabs from mmap, 0 for malloc'd ones */
+    size_t mapped;
+    /* NUMA node the slab was placed on, -1 if left to the kernel */
+    int node;
+    max_align_t align[];
+} _ll_slab_t;
+
+/* Free objects and room left in the slab being carved. LL_NUMA pools keep
+ * one per NUMA node, so that objects are reused on their own node. */
+typedef struct {
+    void *free_list;
+    char *bump;
+    char *bump_end;
+    /* Position in the slab table of the slab being carved */
+    size_t slab;
+} _ll_arena_t;
+
+/* Trailer of every object, backing generation-checked handles. Live
+ * objects have an odd generation, bumped on every alloc and free. */
+typedef struct {
+    uint32_t index;
+    uint32_t generation;
+} _ll_pool_tag_t;
+
+struct ll_pool_t_internal {
+    size_t obj_size;
+    /* Alignment of objects, and offset of the first one in its slab */
+    size_t align;
+    size_t slab_offset;
+    size_t tag_offset;
+    size_t objs_per_slab;
+    _ll_slab_t *slabs;
+    _ll_slab_t *last;
+    _ll_arena_t arena;
+    /* Arenas of LL_NUMA pools by node, and node objects are taken from,
+     * -1 for the node of the allocating thread */
+    _ll_arena_t *arenas;
+    int node;
+    /* Node of the allocating thread when last looked up, and allocations
+     * left before looking it up again */
+    int cpu_node;
+    unsigned int cpu_node_left;
+    /* Slabs in allocation order, mapping object indices to addresses */
+    _ll_slab_t **table;
+    size_t nslabs;
+    size_t table_size;
+    size_t nobjs;
+    size_t live;
+    /* Slabs are mapped on huge pages, and how many of them got some */
+    int huge;
+    size_t hugetlb_slabs;
+    size_t thp_slabs;
+    /* Objects have no tag, and no handles */
+    int untagged;
+};
+
+
+/**
+ * @brief Creates a pool handing out objects of obj_size bytes, carved from
+ * large slabs instead of being allocated one by one
+ */
+ll_pool_t*
+_ll_pool_new(size_t obj_size)
+{
+    return _ll_pool_new_aligned(obj_size, sizeof(max_align_t));
+}
+
+
+static ll_pool_t*
+_ll_pool_init(size_t obj_size, size_t align, size_t min_align, int untagged)
+{
+    ll_pool_t *pool = (ll_pool_t*)calloc(1, sizeof(ll_pool_t));
+    if(pool == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    /* Free objects store the free list link in their first bytes */
+    if(obj_size < sizeof(void*))
+        obj_size = sizeof(void*);
+    if(align < min_align)
+        align = min_align;
+    pool->align = align;
+    pool->untagged = untagged;
+    pool->slab_offset = (sizeof(_ll_slab_t) + align - 1) & ~(align - 1);
+    if(!untagged)
+    {
+        pool->tag_offset = (obj_size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+        obj_size = pool->tag_offset + sizeof(_ll_pool_tag_t);
+    }
+    pool->obj_size = (obj_size + align - 1) & ~(align - 1);
+    pool->objs_per_slab = LLIST_POOL_SLAB_SIZE / pool->obj_size;
+    if(pool->objs_per_slab < LLIST_POOL_MIN_OBJECTS)
+        pool->objs_per_slab = LLIST_POOL_MIN_OBJECTS;
+    return pool;
+}
+
+
+/**
+ * @brief Creates a pool whose objects start at multiples of align, a power
+ * of two, and take a multiple of align bytes
+ */
+ll_pool_t*
+_ll_pool_new_aligned(size_t obj_size, size_t align)
+{
+    return _ll_pool_init(obj_size, align, sizeof(max_align_t), 0);
+}
+
+
+/**
+ * @brief Creates a pool of objects with no trailer, for callers which never
+ * take handles, aligned to align bytes and at least to a pointer. Such
+ * pools cannot be placed on NUMA nodes.
+ */
+ll_pool_t*
+_ll_pool_new_untagged(size_t obj_size, size_t align)
+{
+    return _ll_pool_init(obj_size, align, sizeof(void*), 1);
+}
+
+
+static inline _ll_pool_tag_t*
+_ll_pool_tag(ll_pool_t *pool, void *obj)
+{
+    return (_ll_pool_tag_t*)((char*)obj + pool->tag_offset);
+}
+
+
+/**
+ * @brief Backs the slabs of a pool with 2 MB pages, which cuts the TLB
+ * misses of walks over very long lists. Slabs come from MAP_HUGETLB when
+ * huge pages are reserved, otherwise from a 2 MB aligned mapping advised
+ * with MADV_HUGEPAGE for transparent huge pages.
+ * @return 0 on success, -1 if the pool already has slabs
+ */
+int
+_ll_pool_use_hugepages(ll_pool_t *pool)
+{
+    if(pool->nslabs > 0)
+        return -1;
+    pool->huge = 1;
+    pool->objs_per_slab = (LLIST_POOL_HUGE_SIZE - pool->slab_offset) / pool->obj_size;
+    return 0;
+}
+
+
+/**
+ * @brief Places the slabs of a pool on NUMA nodes, each node having slabs
+ * and free objects of its own. Slabs are mapped so that they can be bound
+ * to a node and migrated.
+ * @return 0 on success, -1 if the pool already has slabs or upon failure
+ */
+int
+_ll_pool_use_numa(ll_pool_t *pool)
+{
+    /* Freed objects find their node through their tag */
+    if(pool->nslabs > 0 || pool->untagged)
+        return -1;
+    pool->arenas = (_ll_arena_t*)calloc(LLIST_NUMA_MAX_NODES, sizeof(_ll_arena_t));
+    if(pool->arenas == NULL)
+    {
+        perror("calloc");
+        return -1;
+    }
+    pool->node = -1;
+    return 0;
+}
+
+
+/**
+ * @brief Sets the node new objects of an LL_NUMA pool come from, -1 for the
+ * node of the allocating thread
+ */
+void
+_ll_pool_set_node(ll_pool_t *pool, int node)
+{
+    pool->node = node;
+    pool->cpu_node_left = 0;
+}
+
+
+/**
+ * @brief Carves what is left of the slab an arena is bumping into free
+ * objects, queued after those already free, so that every object of the
+ * pool has a tag
+ */
+static void
+_ll_pool_retire(ll_pool_t *pool, _ll_arena_t *arena)
+{
+    void **link = &arena->free_list;
+    while(*link != NULL)
+        link = (void**)*link;
+    for(; arena->bump != arena->bump_end; arena->bump += pool->obj_size)
+    {
+        void *obj = arena->bump;
+        if(!pool->untagged)
+        {
+            size_t carved = pool->objs_per_slab - (arena->bump_end - arena->bump) / pool->obj_size;
+            _ll_pool_tag(pool, obj)->index = arena->slab * pool->objs_per_slab + carved;
+            _ll_pool_tag(pool, obj)->generation = 0;
+        }
+        *link = obj;
+        link = (void**)obj;
+    }
+    *link = NULL;
+}
+
+
+/**
+ * @brief Moves the free objects of src in front of those of dst
+ */
+static void
+_ll_pool_splice(_ll_arena_t *dst, _ll_arena_t *src)
+{
+    if(src->free_list == NULL)
+        return;
+    void *tail = src->free_list;
+    while(*(void**)tail != NULL)
+        tail = *(void**)tail;
+    *(void**)tail = dst->free_list;
+    dst->free_list = src->free_list;
+    src->free_list = NULL;
+}
+
+
+/**
+ * @brief Moves every slab of an LL_NUMA pool to a node, which also becomes
+ * the one new objects come from. The free objects of the other nodes are
+ * handed to the arena of that node, so that they are reused there instead
+ * of growing the pool.
+ * @return 0 on success, -1 upon failure
+ */
+int
+_ll_pool_migrate(ll_pool_t *pool, int node)
+{
+    if(pool->arenas == NULL || node < 0 || node >= LLIST_NUMA_MAX_NODES)
+        return -1;
+    pool->node = node;
+    for(_ll_slab_t *slab = pool->slabs; slab != NULL; slab = slab->next)
+    {
+        if(_ll_numa_bind(slab, slab->mapped, node, 1) != 0)
+            return -1;
+        slab->node = node;
+    }
+    for(int i = 0; i < LLIST_NUMA_MAX_NODES; ++i)
+    {
+        if(i == node)
+            continue;
+        _ll_pool_retire(pool, &pool->arenas[i]);
+        _ll_pool_splice(&pool->arenas[node], &pool->arenas[i]);
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Maps a slab of LLIST_POOL_HUGE_SIZE bytes on huge pages if possible
+ * @return Pointer to the mapping, NULL upon failure
+ */
+static char*
+_ll_pool_map(ll_pool_t *pool)
+{
+    size_t len = LLIST_POOL_HUGE_SIZE;
+    char *ptr;
+
+#ifdef MAP_HUGETLB
+    ptr = (char*)mmap(NULL, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(ptr != MAP_FAILED)
+    {
+        ++pool->hugetlb_slabs;
+        return ptr;
+    }
+#endif
+    /* Transparent huge pages need an aligned range: map twice the size and
+     * trim both ends */
+    ptr = (char*)mmap(NULL, 2*len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ptr == MAP_FAILED)
+    {
+        perror("mmap");
+        return NULL;
+    }
+    char *start = (char*)(((uintptr_t)ptr + len - 1) & ~(uintptr_t)(len - 1));
+    if(start > ptr)
+        munmap(ptr, start - ptr);
+    munmap(start + len, ptr + len - start);
+#ifdef MADV_HUGEPAGE
+    if(madvise(start, len, MADV_HUGEPAGE) == 0)
+        ++pool->thp_slabs;
+#endif
+    return start;
+}
+
+
+/**
+ * @brief Allocates a slab with room for objs_per_slab objects
+ * @param node NUMA node to place the slab on, -1 for none
+ * @return Pointer to the slab, NULL upon failure
+ */
+static _ll_slab_t*
+_ll_pool_slab(ll_pool_t *pool, int node)
+{
+    size_t size = pool->slab_offset + pool->obj_size * pool->objs_per_slab;
+    _ll_slab_t *slab;
+
+    if(pool->huge || pool->arenas != NULL)
+    {
+        char *ptr;
+        if(pool->huge)
+        {
+            size = LLIST_POOL_HUGE_SIZE;
+            ptr = _ll_pool_map(pool);
+        }
+        else
+        {
+            size_t page = (size_t)sysconf(_SC_PAGESIZE);
+            size = (size + page - 1) & ~(page - 1);
+            ptr = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(ptr == MAP_FAILED)
+            {
+                perror("mmap");
+                ptr = NULL;
+            }
+        }
+        if(ptr == NULL)
+            return NULL;
+        /* Bound before the first write, which faults the first page in.
+         * Placement is best effort, a failure leaves it to the kernel. */
+        if(node >= 0)
+            _ll_numa_bind(ptr, size, node, 0);
+        slab = (_ll_slab_t*)ptr;
+        slab->mapped = size;
+        slab->node = node;
+        return slab;
+    }
+    if(pool->align > sizeof(max_align_t))
+    {
+        int err = posix_memalign((void**)&slab, pool->align, size);
+        if(err != 0)
+        {
+            fprintf(stderr, "posix_memalign: %s\n", strerror(err));
+            return NULL;
+        }
+    }
+    else if((slab = (_ll_slab_t*)malloc(size)) == NULL)
+    {
+        perror("malloc");
+        return NULL;
+    }
+    slab->mapped = 0;
+    slab->node = -1;
+    return slab;
+}
+
+
+/**
+ * @brief Returns the arena new objects are taken from
+ */
+static inline _ll_arena_t*
+_ll_pool_arena(ll_pool_t *pool, int *node)
+{
+    *node = -1;
+    if(pool->arenas == NULL)
+        return &pool->arena;
+    if(pool->node < 0 && pool->cpu_node_left-- == 0)
+    {
+        /* Threads seldom change node, no need to ask for every object */
+        pool->cpu_node = _ll_numa_current();
+        pool->cpu_node_left = LLIST_POOL_NODE_REFRESH - 1;
+    }
+    *node = pool->node >= 0 ? pool->node : pool->cpu_node;
+    if(*node < 0 || *node >= LLIST_NUMA_MAX_NODES)
+        *node = 0;
+    return &pool->arenas[*node];
+}
+
+
+/**
+ * @brief Returns an uninitialized object, adding a slab when the pool is empty
+ */
+void*
+_ll_pool_alloc(ll_pool_t *pool)
+{
+    int node;
+    _ll_arena_t *arena = _ll_pool_arena(pool, &node);
+    void *obj = arena->free_list;
+    if(obj != NULL)
+    {
+        arena->free_list = *(void**)obj;
+        if(!pool->untagged)
+            ++_ll_pool_tag(pool, obj)->generation;
+        ++pool->live;
+        return obj;
+    }
+
+    if(arena->bump == arena->bump_end)
+    {
+        if(pool->nslabs == pool->table_size)
+        {
+            size_t table_size = pool->table_size ? 2*pool->table_size : 16;
+            _ll_slab_t **table = (_ll_slab_t**)realloc(pool->table, table_size*sizeof(_ll_slab_t*));
+            if(table == NULL)
+            {
+                perror("realloc");
+                return NULL;
+            }
+            pool->table = table;
+            pool->table_size = table_size;
+        }
+        _ll_slab_t *slab = _ll_pool_slab(pool, node);
+        if(slab == NULL)
+            return NULL;
+        if(pool->slabs == NULL)
+            pool->last = slab;
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        arena->slab = pool->nslabs;
+        pool->table[pool->nslabs++] = slab;
+        arena->bump = (char*)slab + pool->slab_offset;
+        arena->bump_end = arena->bump + pool->obj_size * pool->objs_per_slab;
+    }
+    obj = arena->bump;
+    arena->bump += pool->obj_size;
+    ++pool->live;
+    ++pool->nobjs;
+    if(pool->untagged)
+        return obj;
+    size_t carved = pool->objs_per_slab - (arena->bump_end - arena->bump) / pool->obj_size;
+    _ll_pool_tag(pool, obj)->index = arena->slab * pool->objs_per_slab + carved - 1;
+    _ll_pool_tag(pool, obj)->generation = 1;
+    return obj;
+}
+
+
+/**
+ * @brief Returns the object with a given index, NULL if out of range
+ */
+static void*
+_ll_pool_object(ll_pool_t *pool, uint32_t index)
+{
+    if(pool->untagged)
+        return NULL;
+    /* Slabs of LL_NUMA pools are carved side by side, and zero filled */
+    if(index >= (pool->arenas != NULL ? pool->nslabs * pool->objs_per_slab : pool->nobjs))
+        return NULL;
+    _ll_slab_t *slab = pool->table[index / pool->objs_per_slab];
+    return (char*)slab + pool->slab_offset + (index % pool->objs_per_slab) * pool->obj_size;
+}
+
+
+void
+_ll_pool_free(ll_pool_t *pool, void *obj)
+{
+    _ll_arena_t *arena = &pool->arena;
+    _ll_pool_tag_t *tag = _ll_pool_tag(pool, obj);
+    if(pool->arenas != NULL)
+    {
+        /* Back to the arena of the node the object lives on */
+        _ll_slab_t *slab = pool->table[tag->index / pool->objs_per_slab];
+        arena = &pool->arenas[slab->node >= 0 ? slab->node : 0];
+    }
+    if(!pool->untagged)
+        ++tag->generation;
+    --pool->live;
+    *(void**)obj = arena->free_list;
+    arena->free_list = obj;
+}
+
+
+/**
+ * @brief Returns a handle to a live object of the pool, or a handle which
+ * never validates if obj does not come from the pool's own slabs
+ */
+ll_handle_t
+_ll_pool_handle(ll_pool_t *pool, void *obj)
+{
+    ll_handle_t handle = {0, 0};
+    if(pool->untagged)
+        return handle;
+    _ll_pool_tag_t *tag = _ll_pool_tag(pool, obj);
+    if(_ll_pool_object(pool, tag->index) == obj)
+    {
+        handle.index = tag->index;
+        handle.generation = tag->generation;
+    }
+    return handle;
+}
+
+
+/**
+ * @brief Returns the object a handle refers to in O(1), NULL if it was
+ * freed since the handle was taken
+ */
+void*
+_ll_pool_lookup(ll_pool_t *pool, ll_handle_t handle)
+{
+    void *obj = _ll_pool_object(pool, handle.index);
+    if(obj == NULL || (handle.generation & 1) == 0)
+        return NULL;
+    return _ll_pool_tag(pool, obj)->generation == handle.generation ? obj : NULL;
+}
+
+
+/**
+ * @brief Moves the slabs of src, and the objects they hold, into dst and
+ * destroys src, in time linear in the capacity of src
+ *
+ * The slabs of src are appended to the slab table of dst and the indices
+ * of their objects rebased, so that handles taken from dst afterwards
+ * resolve, and the free objects of src are reused by dst. Handles taken
+ * from src before the merge do not carry over.
+ * @return 0 on success, -1 if the pools lay out objects differently or
+ * upon failure, src being left untouched
+ */
+int
+_ll_pool_merge(ll_pool_t *dst, ll_pool_t *src)
+{
+    if(dst->obj_size != src->obj_size || dst->align != src->align ||
+       dst->tag_offset != src->tag_offset || dst->objs_per_slab != src->objs_per_slab ||
+       dst->untagged != src->untagged ||
+       (dst->arenas == NULL) != (src->arenas == NULL))
+        return -1;
+
+    size_t nslabs = dst->nslabs + src->nslabs;
+    if(nslabs > dst->table_size)
+    {
+        _ll_slab_t **table = (_ll_slab_t**)realloc(dst->table, nslabs*sizeof(_ll_slab_t*));
+        if(table == NULL)
+        {
+            perror("realloc");
+            return -1;
+        }
+        dst->table = table;
+        dst->table_size = nslabs;
+    }
+
+    /* Every object index below nslabs * objs_per_slab must name a tagged
+     * object, partly carved slabs are carved to the end */
+    size_t narenas = dst->arenas != NULL ? LLIST_NUMA_MAX_NODES : 1;
+    for(size_t i = 0; i < narenas; ++i)
+    {
+        _ll_pool_retire(dst, dst->arenas != NULL ? &dst->arenas[i] : &dst->arena);
+        _ll_pool_retire(src, src->arenas != NULL ? &src->arenas[i] : &src->arena);
+        _ll_pool_splice(dst->arenas != NULL ? &dst->arenas[i] : &dst->arena,
+                        src->arenas != NULL ? &src->arenas[i] : &src->arena);
+    }
+
+    for(size_t i = 0; i < src->nslabs; ++i)
+    {
+        char *obj = (char*)src->table[i] + src->slab_offset;
+        size_t base = (dst->nslabs + i) * dst->objs_per_slab;
+        for(size_t j = 0; j < src->objs_per_slab && !src->untagged; ++j, obj += src->obj_size)
+            _ll_pool_tag(src, obj)->index = base + j;
+        dst->table[dst->nslabs + i] = src->table[i];
+    }
+    dst->nslabs = nslabs;
+    dst->nobjs = nslabs * dst->objs_per_slab;
+
+    if(src->slabs != NULL)
+    {
+        src->last->next = dst->slabs;
+        dst->slabs = src->slabs;
+        if(dst->last == NULL)
+            dst->last = src->last;
+    }
+    dst->live += src->live;
+    dst->hugetlb_slabs += src->hugetlb_slabs;
+    dst->thp_slabs += src->thp_slabs;
+    free(src->arenas);
+    free(src->table);
+    free(src);
+    return 0;
+}
+
+
+/**
+ * @brief Adds the figures of the pool to stats
+ */
+void
+_ll_pool_stats(ll_pool_t *pool, ll_stats_t *stats)
+{
+    for(_ll_slab_t *slab = pool->slabs; slab != NULL; slab = slab->next)
+    {
+        ++stats->slabs;
+        stats->bytes += slab->mapped > 0 ? slab->mapped :
+                        pool->slab_offset + pool->obj_size * pool->objs_per_slab;
+    }
+    stats->objects += pool->live;
+    stats->hugetlb_slabs += pool->hugetlb_slabs;
+    stats->thp_slabs += pool->thp_slabs;
+}
+
+
+/**
+ * @brief Releases every slab at once, objects are not visited
+ */
+void
+_ll_pool_destroy(ll_pool_t *pool)
+{
+    if(pool == NULL)
+        return;
+    _ll_slab_t *slab = pool->slabs;
+    while(slab != NULL)
+    {
+        _ll_slab_t *next = slab->next;
+        if(slab->mapped > 0)
+            munmap(slab, slab->mapped);
+        else
+            free(slab);
+        slab = next;
+    }
+    free(pool->arenas);
+    free(pool->table);
+    free(pool);
+}
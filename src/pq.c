@@ -0,0 +1,314 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/pq.h>
+#include "ll_internal.h"
+
+/*
+ * Pairing heap whose nodes are regular list nodes: next links a node to
+ * its right sibling and prev to its left sibling, or to its parent for
+ * the leftmost child. The leftmost child of a node is kept in a trailer
+ * after the payload, so the heap needs no allocation besides the node.
+ */
+struct ll_pq_t_internal {
+    ll_t *list;
+    ll_node_t *root;
+    size_t size;
+    size_t child_offset;
+    size_t len;
+    ll_pq_cmp_t cmp;
+};
+
+
+/**
+ * @brief Creates an empty priority queue
+ * @param size Size of each payload
+ * @param cmp Comparison function, the smallest payload is popped first
+ * @return Pointer to the queue, NULL upon failure
+ */
+ll_pq_t*
+ll_pq_new(size_t size, ll_pq_cmp_t cmp)
+{
+    if(size == 0 || cmp == NULL)
+        return NULL;
+
+    ll_pq_t *pq = (ll_pq_t*)calloc(1, sizeof(ll_pq_t));
+    if(pq == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    pq->size = size;
+    pq->child_offset = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    pq->cmp = cmp;
+    pq->list = _ll_new(pq->child_offset + sizeof(ll_node_t*), LL_POOLED);
+    if(pq->list == NULL)
+    {
+        free(pq);
+        return NULL;
+    }
+    return pq;
+}
+
+
+void
+ll_pq_destroy(ll_pq_t *pq)
+{
+    if(pq == NULL)
+        return;
+    /* Nodes are never linked into the list, they only live in its pool */
+    ll_destroy(pq->list);
+    free(pq);
+}
+
+
+size_t
+ll_pq_len(ll_pq_t *pq)
+{
+    return pq != NULL ? pq->len : 0;
+}
+
+
+static inline ll_node_t**
+_ll_pq_child(ll_pq_t *pq, ll_node_t *ptr_node)
+{
+    return (ll_node_t**)((char*)_ll_node_payload(ptr_node) + pq->child_offset);
+}
+
+
+/**
+ * @brief Links two detached heaps, the loser becoming the leftmost child
+ * of the winner. Ties go to a.
+ * @return Root of the resulting heap
+ */
+static ll_node_t*
+_ll_pq_link(ll_pq_t *pq, ll_node_t *a, ll_node_t *b)
+{
+    if(pq->cmp(_ll_node_payload(b), _ll_node_payload(a)) < 0)
+    {
+        ll_node_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    ll_node_t **child = _ll_pq_child(pq, a);
+    b->prev = a;
+    b->next = *child;
+    if(*child != NULL)
+        (*child)->prev = b;
+    *child = b;
+    return a;
+}
+
+
+/**
+ * @brief Detaches the subtree rooted at a non-root node
+ */
+static void
+_ll_pq_cut(ll_pq_t *pq, ll_node_t *ptr_node)
+{
+    ll_node_t **child = _ll_pq_child(pq, ptr_node->prev);
+    if(*child == ptr_node)
+        *child = ptr_node->next;
+    else
+        ptr_node->prev->next = ptr_node->next;
+    if(ptr_node->next != NULL)
+        ptr_node->next->prev = ptr_node->prev;
+    ptr_node->next = NULL;
+    ptr_node->prev = NULL;
+}
+
+
+/**
+ * @brief Merges the children of a node with the standard two pass scheme:
+ * siblings are linked in pairs left to right, then the pairs are folded
+ * right to left
+ * @return Root of the merged heap, NULL if there are no children
+ */
+static ll_node_t*
+_ll_pq_merge_children(ll_pq_t *pq, ll_node_t *ptr_node)
+{
+    ll_node_t *ptr_child = *_ll_pq_child(pq, ptr_node);
+    ll_node_t *pairs = NULL;
+
+    *_ll_pq_child(pq, ptr_node) = NULL;
+    while(ptr_child != NULL)
+    {
+        ll_node_t *a = ptr_child;
+        ll_node_t *b = a->next;
+        ptr_child = b != NULL ? b->next : NULL;
+
+        a->prev = a->next = NULL;
+        if(b != NULL)
+        {
+            b->prev = b->next = NULL;
+            a = _ll_pq_link(pq, a, b);
+        }
+        /* Pairs are stacked through next, so they come back right to left */
+        a->next = pairs;
+        pairs = a;
+    }
+
+    ll_node_t *root = NULL;
+    while(pairs != NULL)
+    {
+        ll_node_t *a = pairs;
+        pairs = a->next;
+        a->next = NULL;
+        root = root != NULL ? _ll_pq_link(pq, root, a) : a;
+    }
+    return root;
+}
+
+
+/**
+ * @brief Inserts a copy of payload in O(1)
+ * @return Handle to the entry, valid until it is popped or deleted, and
+ * whose payload must only be changed through ll_pq_decrease. NULL upon
+ * failure.
+ */
+ll_node_t*
+ll_pq_push(ll_pq_t *pq, const void *payload)
+{
+    if(pq == NULL || payload == NULL)
+        return NULL;
+
+    ll_node_t *ptr_node = _ll_node_new(pq->list, NULL);
+    if(ptr_node == NULL)
+        return NULL;
+    memcpy(_ll_node_payload(ptr_node), payload, pq->size);
+    *_ll_pq_child(pq, ptr_node) = NULL;
+
+    pq->root = pq->root != NULL ? _ll_pq_link(pq, pq->root, ptr_node) : ptr_node;
+    ++pq->len;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Returns the entry with the smallest payload, NULL if empty
+ */
+ll_node_t*
+ll_pq_peek(ll_pq_t *pq)
+{
+    return pq != NULL ? pq->root : NULL;
+}
+
+
+/**
+ * @brief Removes the entry with the smallest payload, in amortized O(log n)
+ * @param payload Receives a copy of the payload, may be NULL
+ * @return 0 on success, -1 if the queue is empty
+ */
+int
+ll_pq_pop(ll_pq_t *pq, void *payload)
+{
+    if(pq == NULL || pq->root == NULL)
+        return -1;
+
+    ll_node_t *ptr_node = pq->root;
+    if(payload != NULL)
+        memcpy(payload, _ll_node_payload(ptr_node), pq->size);
+    pq->root = _ll_pq_merge_children(pq, ptr_node);
+    _ll_free_node(pq->list, ptr_node);
+    --pq->len;
+    return 0;
+}
+
+
+/**
+ * @brief Lowers the payload of an entry: the subtree of the entry is cut
+ * and linked back at the root in O(1), leaving the rest to the next pop.
+ * The amortized cost of pairing heap decreases is known to be o(log n),
+ * its exact bound is open.
+ * @param payload New payload, which must not compare greater than the
+ * current one
+ * @return 0 on success, -1 if payload would increase the entry
+ */
+int
+ll_pq_decrease(ll_pq_t *pq, ll_node_t *ptr_node, const void *payload)
+{
+    if(pq == NULL || ptr_node == NULL || payload == NULL)
+        return -1;
+    if(pq->cmp(payload, _ll_node_payload(ptr_node)) > 0)
+        return -1;
+
+    memcpy(_ll_node_payload(ptr_node), payload, pq->size);
+    if(ptr_node == pq->root)
+        return 0;
+    _ll_pq_cut(pq, ptr_node);
+    pq->root = _ll_pq_link(pq, pq->root, ptr_node);
+    return 0;
+}
+
+
+/**
+ * @brief Removes an arbitrary entry, in amortized O(log n)
+ */
+int
+ll_pq_del(ll_pq_t *pq, ll_node_t *ptr_node)
+{
+    if(pq == NULL || ptr_node == NULL)
+        return -1;
+    if(ptr_node == pq->root)
+        return ll_pq_pop(pq, NULL);
+
+    _ll_pq_cut(pq, ptr_node);
+    ll_node_t *ptr_sub = _ll_pq_merge_children(pq, ptr_node);
+    if(ptr_sub != NULL)
+        pq->root = _ll_pq_link(pq, pq->root, ptr_sub);
+    _ll_free_node(pq->list, ptr_node);
+    --pq->len;
+    return 0;
+}
+
+
+/**
+ * @brief Moves every entry of other into pq and destroys other, in time
+ * linear in the pool capacity of other. Node pointers returned by
+ * ll_pq_push on other stay valid and now refer to entries of pq.
+ * @return 0 on success, -1 if the queues hold payloads of different size
+ * or order them differently, or upon failure, both queues being left
+ * untouched
+ */
+int
+ll_pq_meld(ll_pq_t *pq, ll_pq_t *other)
+{
+    if(pq == NULL || other == NULL || pq == other)
+        return -1;
+    if(pq->size != other->size || pq->cmp != other->cmp)
+        return -1;
+
+    /* Nodes of other now belong to the pool of pq */
+    if(_ll_pool_merge(pq->list->pool, other->list->pool) != 0)
+        return -1;
+    other->list->pool = NULL;
+    ll_destroy(other->list);
+
+    if(other->root != NULL)
+        pq->root = pq->root != NULL ? _ll_pq_link(pq, pq->root, other->root) : other->root;
+    pq->len += other->len;
+    free(other);
+    return 0;
+}
@@ -0,0 +1,654 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+/* Doubles at or above 2^53 have no fractional part the kernel could round */
+#define LLIST_FMT_EXACT_LIMIT             9007199254740992.0
+#define LLIST_FMT_FRAC_DIGITS             1000000
+
+/* Below this many elements per thread, spawning workers does not pay off */
+#define LLIST_PRINT_MT_MIN_SEGMENT        1024
+
+/* Contiguous run of nodes formatted by a single worker */
+typedef struct {
+    ll_node_t *start;
+    size_t count;
+    const ll_t *list;
+    int (*print)(void*, char*);
+    ll_fmt_t fmt;
+    _ll_chunk_t chunk;
+    int ret;
+} _ll_print_segment_t;
+
+static const char _ll_dec_digits[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char _ll_hex_digits[513] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+
+/**
+ * @brief Initializes an empty output chunk
+ * @param size Initial capacity of the chunk in bytes
+ * @return 0 on success, -1 if the buffer could not be allocated
+ */
+int
+_ll_chunk_init(_ll_chunk_t *chunk, size_t size)
+{
+    chunk->buff = (char*)malloc(sizeof(char)*size);
+    if(chunk->buff == NULL)
+    {
+        perror("malloc");
+        return -1;
+    }
+    chunk->buff[0] = '\0';
+    chunk->len = 0;
+    chunk->size = size;
+    chunk->fd = -1;
+    chunk->flushed = 0;
+    return 0;
+}
+
+
+/**
+ * @brief Initializes a chunk of fixed size which is flushed to fd whenever
+ * it fills up, so the output never needs to be held in memory at once
+ */
+int
+_ll_chunk_init_fd(_ll_chunk_t *chunk, size_t size, int fd)
+{
+    if(_ll_chunk_init(chunk, size) != 0)
+        return -1;
+    chunk->fd = fd;
+    return 0;
+}
+
+
+/**
+ * @brief Writes the content of the chunk to its file descriptor and empties it
+ * @return 0 on success, -1 on write failure
+ */
+int
+_ll_chunk_flush(_ll_chunk_t *chunk)
+{
+    struct iovec iov = { .iov_base = chunk->buff, .iov_len = chunk->len };
+
+    if(chunk->fd < 0 || chunk->len == 0)
+        return 0;
+    if(_ll_writev_all(chunk->fd, &iov, 1) != 0)
+    {
+        perror("writev");
+        return -1;
+    }
+    chunk->flushed += chunk->len;
+    chunk->len = 0;
+    return 0;
+}
+
+
+/**
+ * @brief Makes room for len more bytes, plus the string terminator
+ *
+ * Chunks bound to a file descriptor are flushed first and only grow when a
+ * single reservation exceeds their size.
+ * @return Pointer to the first free byte of the chunk, NULL upon failure.
+ * The caller advances chunk->len by the number of bytes actually written.
+ */
+char*
+_ll_chunk_reserve(_ll_chunk_t *chunk, size_t len)
+{
+    if(chunk->size - chunk->len > len)
+        return chunk->buff + chunk->len;
+
+    if(chunk->fd >= 0)
+    {
+        if(_ll_chunk_flush(chunk) != 0)
+            return NULL;
+        if(chunk->size > len)
+            return chunk->buff;
+    }
+
+    size_t new_size = chunk->size;
+    while(new_size - chunk->len <= len)
+        new_size *= 2;
+
+    char *new_buff = (char*)realloc(chunk->buff, sizeof(char)*new_size);
+    if(new_buff == NULL)
+    {
+        perror("realloc");
+        return NULL;
+    }
+    chunk->buff = new_buff;
+    chunk->size = new_size;
+    return chunk->buff + chunk->len;
+}
+
+
+void
+_ll_chunk_free(_ll_chunk_t *chunk)
+{
+    free(chunk->buff);
+    chunk->buff = NULL;
+    chunk->len = chunk->size = 0;
+}
+
+
+static inline size_t
+_ll_count_digits(uint64_t value)
+{
+    size_t digits = 1;
+    for(;;)
+    {
+        if(value < 10)
+            return digits;
+        if(value < 100)
+            return digits + 1;
+        if(value < 1000)
+            return digits + 2;
+        if(value < 10000)
+            return digits + 3;
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+
+/**
+ * @brief Writes the decimal representation of value, two digits per lookup
+ * @return Number of characters written, no terminator is added
+ */
+size_t
+_ll_fmt_u64(char *dst, uint64_t value)
+{
+    size_t len = _ll_count_digits(value);
+    char *ptr = dst + len;
+
+    while(value >= 100)
+    {
+        size_t i = (value % 100) * 2;
+        value /= 100;
+        *--ptr = _ll_dec_digits[i + 1];
+        *--ptr = _ll_dec_digits[i];
+    }
+    if(value >= 10)
+    {
+        size_t i = value * 2;
+        *--ptr = _ll_dec_digits[i + 1];
+        *--ptr = _ll_dec_digits[i];
+    }
+    else
+        *--ptr = '0' + value;
+    return len;
+}
+
+
+size_t
+_ll_fmt_i64(char *dst, int64_t value)
+{
+    if(value >= 0)
+        return _ll_fmt_u64(dst, (uint64_t)value);
+    *dst = '-';
+    return 1 + _ll_fmt_u64(dst + 1, 0 - (uint64_t)value);
+}
+
+
+/**
+ * @brief Writes value with six fractional digits, as printf's "%f" does
+ *
+ * The fractional part is scaled and rounded in double precision. Values
+ * whose rounding is too close to call, non-finite values and values too
+ * large to carry a fractional part are handed over to snprintf, so the
+ * output always matches printf.
+ * @return Number of characters written, no terminator is added
+ */
+size_t
+_ll_fmt_double(char *dst, double value)
+{
+    if(!isfinite(value))
+        goto fallback;
+
+    double abs_value = value < 0 ? -value : value;
+    if(abs_value >= LLIST_FMT_EXACT_LIMIT)
+        goto fallback;
+
+    uint64_t int_part = (uint64_t)abs_value;
+    double scaled = (abs_value - (double)int_part) * LLIST_FMT_FRAC_DIGITS;
+    uint64_t frac_part = (uint64_t)scaled;
+    double rem = scaled - (double)frac_part;
+
+    if(rem > 0.5 - 1e-6 && rem < 0.5 + 1e-6)
+        goto fallback;
+    if(rem > 0.5)
+        ++frac_part;
+    if(frac_part == LLIST_FMT_FRAC_DIGITS)
+    {
+        ++int_part;
+        frac_part = 0;
+    }
+
+    char *ptr = dst;
+    if(signbit(value))
+        *ptr++ = '-';
+    ptr += _ll_fmt_u64(ptr, int_part);
+    *ptr++ = '.';
+    ptr += 6;
+    for(int i = 0; i < 3; ++i)
+    {
+        size_t j = (frac_part % 100) * 2;
+        frac_part /= 100;
+        *--ptr = _ll_dec_digits[j + 1];
+        *--ptr = _ll_dec_digits[j];
+    }
+    return ptr + 6 - dst;
+
+fallback:
+    return (size_t)snprintf(dst, LLIST_FMT_MAX, "%f", value);
+}
+
+
+/**
+ * @brief Writes len bytes as lowercase hex pairs, in memory order
+ */
+size_t
+_ll_fmt_hex(char *dst, const void *bytes, size_t len)
+{
+    const uint8_t *ptr = (const uint8_t*)bytes;
+    for(size_t i = 0; i < len; ++i)
+    {
+        memcpy(dst + 2*i, &_ll_hex_digits[ptr[i]*2], 2);
+    }
+    return 2*len;
+}
+
+
+/**
+ * @brief Checks that payloads of element_size bytes can be printed as fmt
+ * @return 0 if the payload is wide enough, -1 otherwise
+ */
+int
+_ll_fmt_width(ll_fmt_t fmt, size_t element_size)
+{
+    size_t width;
+    switch(fmt)
+    {
+        case LL_FMT_U8:
+        case LL_FMT_I8:
+            width = sizeof(uint8_t);
+            break;
+        case LL_FMT_U16:
+        case LL_FMT_I16:
+            width = sizeof(uint16_t);
+            break;
+        case LL_FMT_U32:
+        case LL_FMT_I32:
+            width = sizeof(uint32_t);
+            break;
+        case LL_FMT_U64:
+        case LL_FMT_I64:
+            width = sizeof(uint64_t);
+            break;
+        case LL_FMT_FLOAT:
+            width = sizeof(float);
+            break;
+        case LL_FMT_DOUBLE:
+            width = sizeof(double);
+            break;
+        case LL_FMT_HEX:
+        case LL_FMT_STR:
+            width = 1;
+            break;
+        default:
+            return -1;
+    }
+    return element_size >= width ? 0 : -1;
+}
+
+
+/**
+ * @brief Upper bound of the characters _ll_fmt_value writes for a payload
+ */
+size_t
+_ll_fmt_len(ll_fmt_t fmt, const void *payload, size_t size)
+{
+    if(fmt == LL_FMT_HEX)
+        return 2*size;
+    if(fmt == LL_FMT_STR)
+        return strnlen((const char*)payload, size);
+    return LLIST_FMT_MAX - 1;
+}
+
+
+/**
+ * @brief Writes the payload formatted as fmt, with no separator nor terminator
+ * @param size Size of the payload, used by LL_FMT_HEX and LL_FMT_STR
+ * @return Number of characters written
+ */
+size_t
+_ll_fmt_value(char *dst, ll_fmt_t fmt, const void *payload, size_t size)
+{
+    union {
+        uint8_t u8; int8_t i8; uint16_t u16; int16_t i16;
+        uint32_t u32; int32_t i32; uint64_t u64; int64_t i64;
+        float f; double d;
+    } v;
+
+    switch(fmt)
+    {
+        case LL_FMT_U8:
+            memcpy(&v.u8, payload, sizeof(v.u8));
+            return _ll_fmt_u64(dst, v.u8);
+        case LL_FMT_I8:
+            memcpy(&v.i8, payload, sizeof(v.i8));
+            return _ll_fmt_i64(dst, v.i8);
+        case LL_FMT_U16:
+            memcpy(&v.u16, payload, sizeof(v.u16));
+            return _ll_fmt_u64(dst, v.u16);
+        case LL_FMT_I16:
+            memcpy(&v.i16, payload, sizeof(v.i16));
+            return _ll_fmt_i64(dst, v.i16);
+        case LL_FMT_U32:
+            memcpy(&v.u32, payload, sizeof(v.u32));
+            return _ll_fmt_u64(dst, v.u32);
+        case LL_FMT_I32:
+            memcpy(&v.i32, payload, sizeof(v.i32));
+            return _ll_fmt_i64(dst, v.i32);
+        case LL_FMT_U64:
+            memcpy(&v.u64, payload, sizeof(v.u64));
+            return _ll_fmt_u64(dst, v.u64);
+        case LL_FMT_I64:
+            memcpy(&v.i64, payload, sizeof(v.i64));
+            return _ll_fmt_i64(dst, v.i64);
+        case LL_FMT_FLOAT:
+            memcpy(&v.f, payload, sizeof(v.f));
+            return _ll_fmt_double(dst, v.f);
+        case LL_FMT_DOUBLE:
+            memcpy(&v.d, payload, sizeof(v.d));
+            return _ll_fmt_double(dst, v.d);
+        case LL_FMT_HEX:
+            return _ll_fmt_hex(dst, payload, size);
+        case LL_FMT_STR:
+            size = strnlen((const char*)payload, size);
+            memcpy(dst, payload, size);
+            return size;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Appends the payload formatted as fmt, followed by a space
+ * @param size Size of the payload, used by LL_FMT_HEX and LL_FMT_STR
+ * @return 0 on success, -1 if the chunk could not grow
+ */
+int
+_ll_fmt_payload(_ll_chunk_t *chunk, ll_fmt_t fmt, const void *payload, size_t size)
+{
+    char *dst = _ll_chunk_reserve(chunk, _ll_fmt_len(fmt, payload, size) + 1);
+    if(dst == NULL)
+        return -1;
+
+    size_t written = _ll_fmt_value(dst, fmt, payload, size);
+    dst[written++] = ' ';
+    dst[written] = '\0';
+    chunk->len += written;
+    return 0;
+}
+
+
+/**
+ * @brief Appends the payload of a node formatted as fmt. Payloads of
+ * LL_VARIABLE lists are checked one by one against the width of fmt.
+ * @return 0 on success, -1 upon failure
+ */
+static int
+_ll_fmt_node(_ll_chunk_t *chunk, const ll_t *ptr_list, ll_fmt_t fmt, ll_node_t *ptr_node)
+{
+    size_t size = _ll_node_size(ptr_list, ptr_node);
+    if((ptr_list->flags & LL_VARIABLE) && fmt != LL_FMT_HEX && fmt != LL_FMT_STR &&
+       _ll_fmt_width(fmt, size) != 0)
+        return -1;
+    return _ll_fmt_payload(chunk, fmt, _ll_node_payload(ptr_node), size);
+}
+
+
+/**
+ * @brief Prints the list with one of the built-in printers
+ *
+ * Produces the same "<element> " sequence a sprintf based callback would,
+ * but formats each payload directly into the output buffer.
+ * @param ptr_list Pointer to the list
+ * @param fmt Type of the payloads. Integer and floating point types read
+ * the first bytes of the payload, LL_FMT_HEX dumps the whole payload and
+ * LL_FMT_STR prints it up to the first NUL byte. On LL_VARIABLE lists
+ * each payload is printed according to its own size.
+ * @return Newly allocated string, NULL upon failure or if the payloads
+ * are narrower than fmt
+ */
+char*
+ll_print_fmt(ll_t *ptr_list, ll_fmt_t fmt)
+{
+    _ll_chunk_t chunk;
+
+    if(ptr_list == NULL ||
+       (!(ptr_list->flags & LL_VARIABLE) && _ll_fmt_width(fmt, ptr_list->element_size) != 0))
+        return NULL;
+
+    if(_ll_chunk_init(&chunk, LLIST_CHUNK_SIZE) != 0)
+        return NULL;
+
+    ll_node_t *root = ptr_list->root;
+    while(root != NULL)
+    {
+        if(_ll_fmt_node(&chunk, ptr_list, fmt, root) != 0)
+        {
+            _ll_chunk_free(&chunk);
+            return NULL;
+        }
+        root = _ll_next(ptr_list, root);
+    }
+    return chunk.buff;
+}
+
+
+/**
+ * @brief Formats one segment of the list into its own chunk
+ */
+static void*
+_ll_print_segment(void *arg)
+{
+    _ll_print_segment_t *seg = (_ll_print_segment_t*)arg;
+    ll_node_t *root = seg->start;
+
+    seg->ret = -1;
+    if(_ll_chunk_init(&seg->chunk, LLIST_CHUNK_SIZE) != 0)
+        return NULL;
+
+    for(size_t i = 0; i < seg->count; ++i, root = root->next)
+    {
+        assert(root != NULL);
+        if(seg->print == NULL)
+        {
+            if(_ll_fmt_node(&seg->chunk, seg->list, seg->fmt, root) != 0)
+                return NULL;
+            continue;
+        }
+        char *dst = _ll_chunk_reserve(&seg->chunk, LLIST_FMT_MAX);
+        if(dst == NULL)
+            return NULL;
+        int written = (*seg->print)(ll_node_payload(root), dst);
+        if(written < 0)
+            return NULL;
+        seg->chunk.len += written;
+    }
+    seg->ret = 0;
+    return NULL;
+}
+
+
+/**
+ * @brief Splits the list into segments, formats them on worker threads and
+ * concatenates the results in list order
+ */
+static char*
+_ll_print_mt(ll_t *ptr_list, int (*print)(void*, char*), ll_fmt_t fmt, unsigned int nthreads)
+{
+    size_t len = ll_len(ptr_list);
+
+    if(nthreads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = cpus > 0 ? (unsigned int)cpus : 1;
+    }
+    if(len / LLIST_PRINT_MT_MIN_SEGMENT < nthreads)
+        nthreads = len / LLIST_PRINT_MT_MIN_SEGMENT;
+    if(nthreads == 0)
+        nthreads = 1;
+
+    _ll_print_segment_t *segs = (_ll_print_segment_t*)calloc(nthreads, sizeof(_ll_print_segment_t));
+    pthread_t *threads = (pthread_t*)calloc(nthreads, sizeof(pthread_t));
+    if(segs == NULL || threads == NULL)
+    {
+        perror("calloc");
+        free(segs);
+        free(threads);
+        return NULL;
+    }
+
+    /* A single walk finds the first node of every segment */
+    ll_node_t *root = ptr_list->root;
+    for(unsigned int t = 0; t < nthreads; ++t)
+    {
+        segs[t].start = root;
+        segs[t].count = len / nthreads + (t < len % nthreads ? 1 : 0);
+        segs[t].list = ptr_list;
+        segs[t].print = print;
+        segs[t].fmt = fmt;
+        for(size_t i = 0; i < segs[t].count; ++i)
+            root = root->next;
+    }
+
+    unsigned int started = 1;
+    for(; started < nthreads; ++started)
+    {
+        if(pthread_create(&threads[started], NULL, _ll_print_segment, &segs[started]) != 0)
+            break;
+    }
+    /* Segments whose worker could not be started are formatted here */
+    for(unsigned int t = started; t < nthreads; ++t)
+        _ll_print_segment(&segs[t]);
+    _ll_print_segment(&segs[0]);
+    for(unsigned int t = 1; t < started; ++t)
+        pthread_join(threads[t], NULL);
+
+    char *buff = NULL;
+    int ret = 0;
+    for(unsigned int t = 0; t < nthreads; ++t)
+        ret |= segs[t].ret;
+    if(ret == 0)
+    {
+        /* Append every other segment to the first chunk */
+        for(unsigned int t = 1; t < nthreads; ++t)
+        {
+            char *dst = _ll_chunk_reserve(&segs[0].chunk, segs[t].chunk.len);
+            if(dst == NULL)
+            {
+                ret = -1;
+                break;
+            }
+            memcpy(dst, segs[t].chunk.buff, segs[t].chunk.len);
+            segs[0].chunk.len += segs[t].chunk.len;
+        }
+    }
+    if(ret == 0)
+    {
+        segs[0].chunk.buff[segs[0].chunk.len] = '\0';
+        buff = segs[0].chunk.buff;
+        segs[0].chunk.buff = NULL;
+    }
+    for(unsigned int t = 0; t < nthreads; ++t)
+        _ll_chunk_free(&segs[t].chunk);
+    free(segs);
+    free(threads);
+    return buff;
+}
+
+
+/**
+ * @brief Parallel version of ll_print
+ *
+ * The list is split into contiguous segments which are formatted
+ * concurrently, each into its own buffer. The output is identical to the
+ * one of ll_print. The list must not be modified during the call and the
+ * callback must be thread safe.
+ * @param ptr_list Pointer to the list
+ * @param print Callback which formats a payload, as for ll_print
+ * @param nthreads Number of threads to use, 0 for one per online CPU.
+ * Short lists use fewer threads.
+ * @return Newly allocated string, NULL upon failure
+ */
+char*
+ll_print_mt(ll_t *ptr_list, int (*print)(void*, char*), unsigned int nthreads)
+{
+    if(ptr_list == NULL || print == NULL)
+        return NULL;
+    return _ll_print_mt(ptr_list, print, LL_FMT_U8, nthreads);
+}
+
+
+/**
+ * @brief Parallel version of ll_print_fmt, see ll_print_mt
+ */
+char*
+ll_print_fmt_mt(ll_t *ptr_list, ll_fmt_t fmt, unsigned int nthreads)
+{
+    if(ptr_list == NULL ||
+       (!(ptr_list->flags & LL_VARIABLE) && _ll_fmt_width(fmt, ptr_list->element_size) != 0))
+        return NULL;
+    return _ll_print_mt(ptr_list, NULL, fmt, nthreads);
+}
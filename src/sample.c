@@ -0,0 +1,174 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+
+/**
+ * @brief Default random source, built on rand() when the caller passes none
+ */
+static uint64_t
+_ll_rand(void *ctx)
+{
+    (void)ctx;
+    return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+}
+
+
+/**
+ * @brief Returns a uniform number in [0, n)
+ */
+static inline size_t
+_ll_rand_below(ll_rng_t rng, void *ctx, size_t n)
+{
+    return (size_t)(rng(ctx) % n);
+}
+
+
+/**
+ * @brief Picks k distinct positions out of n with Floyd's algorithm, in
+ * O(k^2) time and no extra memory
+ */
+static void
+_ll_sample_positions(size_t *pos, size_t k, size_t n, ll_rng_t rng, void *ctx)
+{
+    for(size_t i = 0, j = n - k; i < k; ++i, ++j)
+    {
+        size_t t = _ll_rand_below(rng, ctx, j + 1);
+        for(size_t m = 0; m < i; ++m)
+        {
+            if(pos[m] == t)
+            {
+                t = j;
+                break;
+            }
+        }
+        pos[i] = t;
+    }
+}
+
+
+/**
+ * @brief Draws k distinct nodes uniformly at random
+ *
+ * Unindexed lists are sampled in a single pass with reservoir sampling.
+ * LL_INDEXED lists draw k positions and select them in O(k log n) when k
+ * is small enough for that to beat the walk.
+ * @param nodes Receives the sampled nodes, in no particular order
+ * @param rng Random source, rand() based if NULL
+ * @return Number of nodes sampled, the smaller of k and the length
+ */
+size_t
+ll_sample(ll_t *ptr_list, ll_node_t **nodes, size_t k, ll_rng_t rng, void *ctx)
+{
+    if(ptr_list == NULL || nodes == NULL || k == 0)
+        return 0;
+    if(rng == NULL)
+        rng = _ll_rand;
+
+    if(ptr_list->flags & LL_INDEXED)
+    {
+        size_t len = ll_len(ptr_list);
+        if(k > len)
+            k = len;
+        if(k*k <= len)
+        {
+            size_t *pos = (size_t*)malloc(k*sizeof(size_t));
+            if(pos != NULL)
+            {
+                _ll_sample_positions(pos, k, len, rng, ctx);
+                for(size_t i = 0; i < k; ++i)
+                    nodes[i] = _ll_index_select(ptr_list, pos[i]);
+                free(pos);
+                return k;
+            }
+            perror("malloc");
+        }
+    }
+
+    size_t seen = 0;
+    for(ll_node_t *ptr_node = ptr_list->root; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+    {
+        if(seen < k)
+            nodes[seen] = ptr_node;
+        else
+        {
+            size_t j = _ll_rand_below(rng, ctx, seen + 1);
+            if(j < k)
+                nodes[j] = ptr_node;
+        }
+        ++seen;
+    }
+    return seen < k ? seen : k;
+}
+
+
+/**
+ * @brief Shuffles the list in place: node pointers are gathered in a
+ * temporary array, permuted with Fisher-Yates and relinked in that order.
+ * Payloads are not moved, so node pointers and handles stay valid.
+ * @param rng Random source, rand() based if NULL
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_shuffle(ll_t *ptr_list, ll_rng_t rng, void *ctx)
+{
+    if(ptr_list == NULL)
+        return -1;
+    if(rng == NULL)
+        rng = _ll_rand;
+
+    size_t len = ll_len(ptr_list);
+    if(len < 2)
+        return 0;
+    ll_node_t **nodes = (ll_node_t**)malloc(len*sizeof(ll_node_t*));
+    if(nodes == NULL)
+    {
+        perror("malloc");
+        return -1;
+    }
+
+    size_t n = 0;
+    for(ll_node_t *ptr_node = ptr_list->root; ptr_node != NULL; ptr_node = _ll_next(ptr_list, ptr_node))
+        nodes[n++] = ptr_node;
+    for(size_t i = len - 1; i > 0; --i)
+    {
+        size_t j = _ll_rand_below(rng, ctx, i + 1);
+        ll_node_t *tmp = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = tmp;
+    }
+
+    /* Relinking from scratch also rebuilds the index of LL_INDEXED lists */
+    ptr_list->root = NULL;
+    ptr_list->len = 0;
+    ptr_list->index = NULL;
+    for(size_t i = 0; i < len; ++i)
+        nodes[i]->next = nodes[i]->prev = NULL;
+    for(size_t i = 0; i < len; ++i)
+        _ll_link_after(ptr_list, i > 0 ? nodes[i - 1] : NULL, nodes[i]);
+    free(nodes);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+
+static inline size_t*
+_ll_shared_refs(ll_t *ptr_list, void *payload)
+{
+    return &((_ll_shared_t*)((char*)payload - _ll_shared_offset(ptr_list)))->refs;
+}
+
+
+/**
+ * @brief Inserts in position pos of an LL_SHARED list a payload already
+ * held by a node of an LL_SHARED list, taking a reference to it instead of
+ * copying it
+ * @param payload Payload returned by ll_node_payload for a node of a list
+ * with the same element size and alignment, possibly ptr_list itself
+ * @return Pointer to the list or NULL upon failure
+ */
+ll_t*
+ll_insert_shared(ll_t *ptr_list, void *payload, size_t pos)
+{
+    if(ptr_list == NULL || payload == NULL || !(ptr_list->flags & LL_SHARED) || pos > ll_len(ptr_list))
+        return NULL;
+
+    ll_node_t *ptr_node = (ll_node_t*)malloc(sizeof(ll_node_t) + sizeof(ll_data_t));
+    if(ptr_node == NULL)
+    {
+        perror("malloc");
+        return NULL;
+    }
+    __atomic_add_fetch(_ll_shared_refs(ptr_list, payload), 1, __ATOMIC_RELAXED);
+    ptr_node->data = (ll_data_t*)(ptr_node + 1);
+    ptr_node->data->payload = payload;
+    ptr_node->next = NULL;
+    ptr_node->prev = NULL;
+    _ll_link_after(ptr_list, pos > 0 ? ll_node_get(ptr_list, pos - 1) : NULL, ptr_node);
+    return ptr_list;
+}
+
+
+/**
+ * @brief Returns the payload of a node for writing
+ *
+ * On LL_SHARED lists a payload which other nodes also hold is copied
+ * first, so that the change is only seen through this node. Payloads of
+ * other lists are returned as they are.
+ * @return Pointer to the payload, NULL upon failure
+ */
+void*
+ll_node_payload_mut(ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    if(ptr_list == NULL || ptr_node == NULL)
+        return NULL;
+    void *payload = ptr_node->data->payload;
+    if(!(ptr_list->flags & LL_SHARED) ||
+       __atomic_load_n(_ll_shared_refs(ptr_list, payload), __ATOMIC_ACQUIRE) == 1)
+        return payload;
+
+    void *copy = _ll_shared_new(ptr_list, payload);
+    if(copy == NULL)
+        return NULL;
+    ptr_node->data->payload = copy;
+    _ll_shared_release(ptr_list, payload);
+    return copy;
+}
+
+
+/**
+ * @brief Returns how many nodes, across all lists, hold the payload of a
+ * node. Payloads of lists other than LL_SHARED ones have one.
+ */
+size_t
+ll_payload_refs(ll_t *ptr_list, ll_node_t *ptr_node)
+{
+    if(ptr_list == NULL || ptr_node == NULL)
+        return 0;
+    if(!(ptr_list->flags & LL_SHARED))
+        return 1;
+    return __atomic_load_n(_ll_shared_refs(ptr_list, ptr_node->data->payload), __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,258 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <libll/ll.h>
+#include "ll_internal.h"
+
+#define LLIST_STRTAB_BUCKETS              16
+
+typedef struct _ll_str_t {
+    struct _ll_str_t *next;
+    /* Nodes sharing the string */
+    size_t refs;
+    uint64_t hash;
+    size_t len;
+    char bytes[];
+} _ll_str_t;
+
+struct ll_strtab_t_internal {
+    _ll_str_t **buckets;
+    size_t nbuckets;
+    size_t len;
+    /* Lists using the table, plus the owner until ll_strtab_destroy */
+    size_t refs;
+};
+
+
+/**
+ * @brief Creates an empty table interning the strings of LL_STRING lists
+ * @return Pointer to the table, NULL upon failure
+ */
+ll_strtab_t*
+ll_strtab_new(void)
+{
+    ll_strtab_t *strtab = (ll_strtab_t*)calloc(1, sizeof(ll_strtab_t));
+    if(strtab == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    strtab->buckets = (_ll_str_t**)calloc(LLIST_STRTAB_BUCKETS, sizeof(_ll_str_t*));
+    if(strtab->buckets == NULL)
+    {
+        perror("calloc");
+        free(strtab);
+        return NULL;
+    }
+    strtab->nbuckets = LLIST_STRTAB_BUCKETS;
+    strtab->refs = 1;
+    return strtab;
+}
+
+
+/**
+ * @brief Releases a table. The table is actually freed once the lists
+ * using it are destroyed as well.
+ */
+void
+ll_strtab_destroy(ll_strtab_t *strtab)
+{
+    if(strtab == NULL || --strtab->refs > 0)
+        return;
+    for(size_t b = 0; b < strtab->nbuckets; ++b)
+    {
+        _ll_str_t *str = strtab->buckets[b];
+        while(str != NULL)
+        {
+            _ll_str_t *next = str->next;
+            free(str);
+            str = next;
+        }
+    }
+    free(strtab->buckets);
+    free(strtab);
+}
+
+
+/**
+ * @brief Returns the number of distinct strings in the table
+ */
+size_t
+ll_strtab_len(ll_strtab_t *strtab)
+{
+    return strtab != NULL ? strtab->len : 0;
+}
+
+
+/**
+ * @brief Makes an empty LL_STRING list intern its strings in a table, so
+ * that equal strings of all the lists sharing the table are stored once.
+ * Searches then compare addresses rather than bytes. Interned strings must
+ * not be changed through ll_node_payload.
+ * @return 0 on success, -1 if the list is not an empty LL_STRING list or
+ * already has a table
+ */
+int
+ll_set_strtab(ll_t *ptr_list, ll_strtab_t *strtab)
+{
+    if(ptr_list == NULL || strtab == NULL || !(ptr_list->flags & LL_STRING) ||
+       ptr_list->root != NULL || ptr_list->strtab != NULL)
+        return -1;
+    ++strtab->refs;
+    ptr_list->strtab = strtab;
+    return 0;
+}
+
+
+static _ll_str_t**
+_ll_strtab_slot(ll_strtab_t *strtab, const void *bytes, size_t len, uint64_t hash)
+{
+    _ll_str_t **slot = &strtab->buckets[hash & (strtab->nbuckets - 1)];
+    while(*slot != NULL &&
+          ((*slot)->hash != hash || (*slot)->len != len || memcmp((*slot)->bytes, bytes, len) != 0))
+        slot = &(*slot)->next;
+    return slot;
+}
+
+
+/**
+ * @brief Returns the interned copy of a string, NULL if there is none
+ */
+const char*
+_ll_strtab_find(ll_strtab_t *strtab, const void *bytes, size_t len, uint64_t hash)
+{
+    _ll_str_t *str = *_ll_strtab_slot(strtab, bytes, len, hash);
+    return str != NULL ? str->bytes : NULL;
+}
+
+
+/**
+ * @brief Doubles the buckets of a table. Failing to is not an error, the
+ * chains just get longer.
+ */
+static void
+_ll_strtab_grow(ll_strtab_t *strtab)
+{
+    size_t nbuckets = strtab->nbuckets * 2;
+    _ll_str_t **buckets = (_ll_str_t**)calloc(nbuckets, sizeof(_ll_str_t*));
+    if(buckets == NULL)
+        return;
+    for(size_t b = 0; b < strtab->nbuckets; ++b)
+    {
+        _ll_str_t *str = strtab->buckets[b];
+        while(str != NULL)
+        {
+            _ll_str_t *next = str->next;
+            str->next = buckets[str->hash & (nbuckets - 1)];
+            buckets[str->hash & (nbuckets - 1)] = str;
+            str = next;
+        }
+    }
+    free(strtab->buckets);
+    strtab->buckets = buckets;
+    strtab->nbuckets = nbuckets;
+}
+
+
+/**
+ * @brief Takes a reference to the interned copy of a string, adding it to
+ * the table if needed
+ * @return The NUL terminated copy, NULL upon failure
+ */
+const char*
+_ll_strtab_intern(ll_strtab_t *strtab, const void *bytes, size_t len, uint64_t hash)
+{
+    _ll_str_t **slot = _ll_strtab_slot(strtab, bytes, len, hash);
+    if(*slot == NULL)
+    {
+        _ll_str_t *str = (_ll_str_t*)malloc(sizeof(_ll_str_t) + len + 1);
+        if(str == NULL)
+        {
+            perror("malloc");
+            return NULL;
+        }
+        str->next = NULL;
+        str->refs = 0;
+        str->hash = hash;
+        str->len = len;
+        memcpy(str->bytes, bytes, len);
+        str->bytes[len] = '\0';
+        *slot = str;
+        if(++strtab->len > strtab->nbuckets)
+        {
+            _ll_strtab_grow(strtab);
+            slot = _ll_strtab_slot(strtab, bytes, len, hash);
+        }
+    }
+    ++(*slot)->refs;
+    return (*slot)->bytes;
+}
+
+
+/**
+ * @brief Drops a reference to an interned string, freeing the string
+ * with the last one
+ */
+void
+_ll_strtab_release(ll_strtab_t *strtab, const void *bytes)
+{
+    _ll_str_t *str = (_ll_str_t*)((const char*)bytes - offsetof(_ll_str_t, bytes));
+    if(--str->refs > 0)
+        return;
+    _ll_str_t **slot = &strtab->buckets[str->hash & (strtab->nbuckets - 1)];
+    while(*slot != str)
+        slot = &(*slot)->next;
+    *slot = str->next;
+    --strtab->len;
+    free(str);
+}
+
+
+/**
+ * @brief Inserts a copy of a NUL terminated string in position pos of an
+ * LL_STRING list. Payloads keep the terminator, which ll_node_size does
+ * not count.
+ * @return Pointer to the list or NULL upon failure
+ */
+ll_t*
+ll_insert_str(ll_t *ptr_list, const char *str, size_t pos)
+{
+    if(ptr_list == NULL || str == NULL || !(ptr_list->flags & LL_STRING))
+        return NULL;
+    return ll_insert_var(ptr_list, str, strlen(str), pos);
+}
+
+
+/**
+ * @brief Returns the first node of an LL_STRING list holding a string,
+ * NULL if there is none
+ */
+ll_node_t*
+ll_search_str(ll_t *ptr_list, const char *str)
+{
+    if(ptr_list == NULL || str == NULL || !(ptr_list->flags & LL_STRING))
+        return NULL;
+    return ll_search_var(ptr_list, str, strlen(str));
+}
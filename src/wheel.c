@@ -0,0 +1,279 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/wheel.h>
+#include "ll_internal.h"
+
+#define LLIST_WHEEL_LEVELS                4
+#define LLIST_WHEEL_BITS                  8
+#define LLIST_WHEEL_SLOTS                 (1 << LLIST_WHEEL_BITS)
+#define LLIST_WHEEL_MASK                  (LLIST_WHEEL_SLOTS - 1)
+
+/* Furthest expiry the wheel can tell apart, later timers are parked on the
+ * last level and cascaded again until they get within range */
+#define LLIST_WHEEL_SPAN                  (((uint64_t)1 << (LLIST_WHEEL_LEVELS*LLIST_WHEEL_BITS)) - 1)
+
+/* Trailer of each timer payload */
+typedef struct {
+    uint64_t expires;
+    ll_t *slot;
+} _ll_wheel_meta_t;
+
+struct ll_wheel_t_internal {
+    /* Next tick to be processed */
+    uint64_t now;
+    size_t len;
+    size_t data_size;
+    size_t meta_offset;
+    ll_pool_t *pool;
+    /* Timers of the slot being expired, spliced out of the wheel */
+    ll_t expired;
+    ll_t slots[LLIST_WHEEL_LEVELS][LLIST_WHEEL_SLOTS];
+};
+
+
+/**
+ * @brief Creates an empty hierarchical timer wheel
+ *
+ * The wheel has four levels of 256 slots, level l covering expiries up to
+ * 256^(l+1) ticks away. Each slot is a list of timers and all the lists
+ * share one node pool. A timer is a node whose payload holds data_size
+ * bytes of user data followed by its expiry.
+ * @param now Current tick, in units chosen by the caller
+ * @return Pointer to the wheel, NULL upon failure
+ */
+ll_wheel_t*
+ll_wheel_new(size_t data_size, uint64_t now)
+{
+    ll_wheel_t *wheel = (ll_wheel_t*)calloc(1, sizeof(ll_wheel_t));
+    if(wheel == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    wheel->now = now;
+    wheel->data_size = data_size;
+    wheel->meta_offset = (data_size + 7) & ~(size_t)7;
+    size_t size = wheel->meta_offset + sizeof(_ll_wheel_meta_t);
+    wheel->pool = _ll_pool_new(sizeof(ll_node_t) + sizeof(ll_data_t) + size);
+    if(wheel->pool == NULL)
+    {
+        free(wheel);
+        return NULL;
+    }
+
+    _ll_list_init(&wheel->expired, size, LL_POOLED, 0);
+    wheel->expired.pool = wheel->pool;
+    for(size_t l = 0; l < LLIST_WHEEL_LEVELS; ++l)
+    {
+        for(size_t s = 0; s < LLIST_WHEEL_SLOTS; ++s)
+        {
+            _ll_list_init(&wheel->slots[l][s], size, LL_POOLED, 0);
+            wheel->slots[l][s].pool = wheel->pool;
+        }
+    }
+    return wheel;
+}
+
+
+void
+ll_wheel_destroy(ll_wheel_t *wheel)
+{
+    if(wheel == NULL)
+        return;
+    /* Timers live in the pool slabs, no need to walk the slots */
+    _ll_pool_destroy(wheel->pool);
+    free(wheel);
+}
+
+
+size_t
+ll_wheel_len(ll_wheel_t *wheel)
+{
+    return wheel != NULL ? wheel->len : 0;
+}
+
+
+static inline _ll_wheel_meta_t*
+_ll_wheel_meta(ll_wheel_t *wheel, ll_node_t *ptr_node)
+{
+    return (_ll_wheel_meta_t*)((char*)_ll_node_payload(ptr_node) + wheel->meta_offset);
+}
+
+
+/**
+ * @brief Links an unlinked timer into the slot matching its expiry
+ */
+static void
+_ll_wheel_place(ll_wheel_t *wheel, ll_node_t *ptr_node)
+{
+    _ll_wheel_meta_t *meta = _ll_wheel_meta(wheel, ptr_node);
+    uint64_t expires = meta->expires;
+    size_t level = 0;
+
+    /* Overdue timers fire on the next tick */
+    if(expires < wheel->now)
+        expires = wheel->now;
+    if(expires - wheel->now > LLIST_WHEEL_SPAN)
+        expires = wheel->now + LLIST_WHEEL_SPAN;
+    uint64_t delta = expires - wheel->now;
+    while(level < LLIST_WHEEL_LEVELS - 1 && delta >> ((level + 1)*LLIST_WHEEL_BITS) != 0)
+        ++level;
+
+    ll_t *slot = &wheel->slots[level][(expires >> (level*LLIST_WHEEL_BITS)) & LLIST_WHEEL_MASK];
+    _ll_link_after(slot, NULL, ptr_node);
+    meta->slot = slot;
+}
+
+
+/**
+ * @brief Schedules a timer
+ * @param expires Tick at which the timer fires, past ticks fire on the next
+ * call to ll_wheel_advance
+ * @param data data_size bytes copied into the timer, NULL to leave them
+ * uninitialized
+ * @return Handle to the timer, whose payload is the user data. The handle
+ * is valid until the timer fires or is cancelled. NULL upon failure.
+ */
+ll_node_t*
+ll_wheel_schedule(ll_wheel_t *wheel, uint64_t expires, const void *data)
+{
+    if(wheel == NULL)
+        return NULL;
+
+    ll_node_t *ptr_node = _ll_node_new(&wheel->expired, NULL);
+    if(ptr_node == NULL)
+        return NULL;
+    if(data != NULL)
+        memcpy(_ll_node_payload(ptr_node), data, wheel->data_size);
+    _ll_wheel_meta(wheel, ptr_node)->expires = expires;
+    _ll_wheel_place(wheel, ptr_node);
+    ++wheel->len;
+    return ptr_node;
+}
+
+
+/**
+ * @brief Cancels a pending timer in O(1)
+ * @return 0 on success, -1 if the timer is already firing
+ */
+int
+ll_wheel_cancel(ll_wheel_t *wheel, ll_node_t *ptr_timer)
+{
+    if(wheel == NULL || ptr_timer == NULL)
+        return -1;
+
+    _ll_wheel_meta_t *meta = _ll_wheel_meta(wheel, ptr_timer);
+    if(meta->slot == NULL)
+        return -1;
+    _ll_unlink(meta->slot, ptr_timer);
+    _ll_free_node(meta->slot, ptr_timer);
+    --wheel->len;
+    return 0;
+}
+
+
+/**
+ * @brief Moves all the timers of a slot down to the lower levels
+ * @return Index of the slot
+ */
+static size_t
+_ll_wheel_cascade(ll_wheel_t *wheel, size_t level)
+{
+    size_t index = (wheel->now >> (level*LLIST_WHEEL_BITS)) & LLIST_WHEEL_MASK;
+    ll_t *slot = &wheel->slots[level][index];
+    ll_node_t *ptr_node = slot->root;
+
+    slot->root = NULL;
+    slot->len = 0;
+    while(ptr_node != NULL)
+    {
+        ll_node_t *ptr_next = ptr_node->next;
+        _ll_wheel_place(wheel, ptr_node);
+        ptr_node = ptr_next;
+    }
+    return index;
+}
+
+
+/**
+ * @brief Processes every tick up to now included, firing expired timers
+ *
+ * Whenever the first level wraps around, the matching slot of the level
+ * above is cascaded down. Each slot reaching expiry is spliced out of the
+ * wheel as a whole before its timers fire, so callbacks may schedule and
+ * cancel timers, including those of the same slot still waiting to fire.
+ * @param now Current tick, lower than UINT64_MAX so that the tick after it
+ * exists
+ * @param expire Callback invoked with the data of each expired timer, may
+ * be NULL
+ * @return Number of timers fired
+ */
+size_t
+ll_wheel_advance(ll_wheel_t *wheel, uint64_t now, ll_wheel_expire_t expire, void *ctx)
+{
+    size_t fired = 0;
+
+    if(wheel == NULL || now == UINT64_MAX)
+        return 0;
+
+    while(wheel->now <= now)
+    {
+        if(wheel->len == 0)
+        {
+            wheel->now = now + 1;
+            break;
+        }
+
+        size_t index = wheel->now & LLIST_WHEEL_MASK;
+        for(size_t level = 1; index == 0 && level < LLIST_WHEEL_LEVELS; ++level)
+            index = _ll_wheel_cascade(wheel, level);
+
+        ll_t *slot = &wheel->slots[0][wheel->now & LLIST_WHEEL_MASK];
+        ++wheel->now;
+        if(slot->root == NULL)
+            continue;
+
+        wheel->expired.root = slot->root;
+        wheel->expired.len = slot->len;
+        slot->root = NULL;
+        slot->len = 0;
+        for(ll_node_t *ptr_node = wheel->expired.root; ptr_node != NULL; ptr_node = ptr_node->next)
+            _ll_wheel_meta(wheel, ptr_node)->slot = &wheel->expired;
+
+        while(wheel->expired.root != NULL)
+        {
+            ll_node_t *ptr_node = wheel->expired.root;
+            _ll_unlink(&wheel->expired, ptr_node);
+            _ll_wheel_meta(wheel, ptr_node)->slot = NULL;
+            --wheel->len;
+            ++fired;
+            if(expire != NULL)
+                expire(_ll_node_payload(ptr_node), ctx);
+            _ll_free_node(&wheel->expired, ptr_node);
+        }
+    }
+    return fired;
+}
@@ -0,0 +1,306 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/xor.h>
+#include "ll_internal.h"
+
+struct ll_xor_node_t_internal {
+    /* Address of the previous node XOR address of the next one, NULL
+     * standing for 0 at both ends */
+    uintptr_t link;
+    uint64_t payload[];
+};
+
+struct ll_xor_t_internal {
+    ll_xor_node_t *head;
+    ll_xor_node_t *tail;
+    size_t len;
+    size_t element_size;
+    ll_pool_t *pool;
+};
+
+
+static inline ll_xor_node_t*
+_ll_xor_other(ll_xor_node_t *ptr_node, ll_xor_node_t *ptr_neighbour)
+{
+    return (ll_xor_node_t*)(ptr_node->link ^ (uintptr_t)ptr_neighbour);
+}
+
+
+/**
+ * @brief Replaces neighbour old of a node with neighbour new
+ */
+static inline void
+_ll_xor_relink(ll_xor_node_t *ptr_node, ll_xor_node_t *old, ll_xor_node_t *new)
+{
+    if(ptr_node != NULL)
+        ptr_node->link ^= (uintptr_t)old ^ (uintptr_t)new;
+}
+
+
+/**
+ * @brief Creates an empty XOR linked list of elements of size bytes
+ *
+ * Nodes are carved from a pool without handle tags and take one word
+ * besides the payload, rounded up to 8 bytes, against four words for the
+ * nodes of an ll_t.
+ * @return Pointer to the list, NULL if size is 0 or upon failure
+ */
+ll_xor_t*
+ll_xor_new(size_t size)
+{
+    if(size == 0)
+        return NULL;
+
+    ll_xor_t *ptr_list = (ll_xor_t*)calloc(1, sizeof(ll_xor_t));
+    if(ptr_list == NULL)
+    {
+        perror("calloc");
+        return NULL;
+    }
+    ptr_list->element_size = size;
+    ptr_list->pool = _ll_pool_new_untagged(sizeof(ll_xor_node_t) + _ll_round(size, sizeof(uint64_t)),
+                                           sizeof(uint64_t));
+    if(ptr_list->pool == NULL)
+    {
+        free(ptr_list);
+        return NULL;
+    }
+    return ptr_list;
+}
+
+
+void
+ll_xor_destroy(ll_xor_t *ptr_list)
+{
+    if(ptr_list == NULL)
+        return;
+    _ll_pool_destroy(ptr_list->pool);
+    free(ptr_list);
+}
+
+
+size_t
+ll_xor_len(ll_xor_t *ptr_list)
+{
+    return ptr_list != NULL ? ptr_list->len : 0;
+}
+
+
+/**
+ * @brief Returns the memory taken by the list, see ll_stats
+ */
+int
+ll_xor_stats(ll_xor_t *ptr_list, ll_stats_t *stats)
+{
+    if(ptr_list == NULL || stats == NULL)
+        return -1;
+    memset(stats, 0, sizeof(ll_stats_t));
+    _ll_pool_stats(ptr_list->pool, stats);
+    return 0;
+}
+
+
+/**
+ * @brief Returns an iterator on the first element, equal to ll_xor_end on
+ * empty lists
+ */
+ll_xor_iter_t
+ll_xor_begin(ll_xor_t *ptr_list)
+{
+    ll_xor_iter_t it = {NULL, ptr_list != NULL ? ptr_list->head : NULL};
+    return it;
+}
+
+
+/**
+ * @brief Returns an iterator past the last element. Going back from it
+ * visits the list from the tail.
+ */
+ll_xor_iter_t
+ll_xor_end(ll_xor_t *ptr_list)
+{
+    ll_xor_iter_t it = {ptr_list != NULL ? ptr_list->tail : NULL, NULL};
+    return it;
+}
+
+
+/**
+ * @brief Moves an iterator to the next element. cur must not be NULL.
+ */
+ll_xor_iter_t
+ll_xor_next(ll_xor_iter_t it)
+{
+    ll_xor_iter_t next = {it.cur, _ll_xor_other(it.cur, it.prev)};
+    return next;
+}
+
+
+/**
+ * @brief Moves an iterator to the previous element. prev must not be NULL.
+ */
+ll_xor_iter_t
+ll_xor_prev(ll_xor_iter_t it)
+{
+    ll_xor_iter_t prev = {_ll_xor_other(it.prev, it.cur), it.prev};
+    return prev;
+}
+
+
+/**
+ * @brief Returns the payload at an iterator, NULL past the back
+ */
+void*
+ll_xor_payload(ll_xor_iter_t it)
+{
+    return it.cur != NULL ? (void*)it.cur->payload : NULL;
+}
+
+
+/**
+ * @brief Returns an iterator on the first element equal to payload,
+ * ll_xor_end if there is none
+ */
+ll_xor_iter_t
+ll_xor_search(ll_xor_t *ptr_list, const void *payload)
+{
+    ll_xor_iter_t it = ll_xor_begin(ptr_list);
+    if(ptr_list == NULL || payload == NULL)
+        return it;
+    while(it.cur != NULL && memcmp(it.cur->payload, payload, ptr_list->element_size) != 0)
+        it = ll_xor_next(it);
+    return it;
+}
+
+
+/**
+ * @brief Inserts an element before the one at an iterator, or at the back
+ * if the iterator is past it
+ *
+ * Other iterators on it->prev and it->cur are invalidated.
+ * @param it Moved to the new element
+ * @return 0 on success, -1 upon failure
+ */
+int
+ll_xor_insert(ll_xor_t *ptr_list, ll_xor_iter_t *it, const void *payload)
+{
+    if(ptr_list == NULL || it == NULL || payload == NULL)
+        return -1;
+    ll_xor_node_t *ptr_node = (ll_xor_node_t*)_ll_pool_alloc(ptr_list->pool);
+    if(ptr_node == NULL)
+        return -1;
+    memcpy(ptr_node->payload, payload, ptr_list->element_size);
+    ptr_node->link = (uintptr_t)it->prev ^ (uintptr_t)it->cur;
+
+    _ll_xor_relink(it->prev, it->cur, ptr_node);
+    _ll_xor_relink(it->cur, it->prev, ptr_node);
+    if(it->prev == NULL)
+        ptr_list->head = ptr_node;
+    if(it->cur == NULL)
+        ptr_list->tail = ptr_node;
+    it->cur = ptr_node;
+    ++ptr_list->len;
+    return 0;
+}
+
+
+/**
+ * @brief Removes the element at an iterator
+ *
+ * Other iterators on the removed element and its neighbours are
+ * invalidated.
+ * @param it Moved to the element which followed the removed one
+ * @return 0 on success, -1 if the iterator is past the back
+ */
+int
+ll_xor_erase(ll_xor_t *ptr_list, ll_xor_iter_t *it)
+{
+    if(ptr_list == NULL || it == NULL || it->cur == NULL)
+        return -1;
+    ll_xor_node_t *ptr_node = it->cur;
+    ll_xor_node_t *ptr_next = _ll_xor_other(ptr_node, it->prev);
+
+    _ll_xor_relink(it->prev, ptr_node, ptr_next);
+    _ll_xor_relink(ptr_next, ptr_node, it->prev);
+    if(it->prev == NULL)
+        ptr_list->head = ptr_next;
+    if(ptr_next == NULL)
+        ptr_list->tail = it->prev;
+    _ll_pool_free(ptr_list->pool, ptr_node);
+    it->cur = ptr_next;
+    --ptr_list->len;
+    return 0;
+}
+
+
+int
+ll_xor_push_front(ll_xor_t *ptr_list, const void *payload)
+{
+    ll_xor_iter_t it = ll_xor_begin(ptr_list);
+    return ll_xor_insert(ptr_list, &it, payload);
+}
+
+
+int
+ll_xor_push_back(ll_xor_t *ptr_list, const void *payload)
+{
+    ll_xor_iter_t it = ll_xor_end(ptr_list);
+    return ll_xor_insert(ptr_list, &it, payload);
+}
+
+
+/**
+ * @brief Removes the first element
+ * @param payload Receives a copy of the element, may be NULL
+ * @return 0 on success, -1 if the list is empty
+ */
+int
+ll_xor_pop_front(ll_xor_t *ptr_list, void *payload)
+{
+    ll_xor_iter_t it = ll_xor_begin(ptr_list);
+    if(it.cur == NULL)
+        return -1;
+    if(payload != NULL)
+        memcpy(payload, it.cur->payload, ptr_list->element_size);
+    return ll_xor_erase(ptr_list, &it);
+}
+
+
+/**
+ * @brief Removes the last element
+ * @param payload Receives a copy of the element, may be NULL
+ * @return 0 on success, -1 if the list is empty
+ */
+int
+ll_xor_pop_back(ll_xor_t *ptr_list, void *payload)
+{
+    ll_xor_iter_t it = ll_xor_end(ptr_list);
+    if(it.prev == NULL)
+        return -1;
+    it = ll_xor_prev(it);
+    if(payload != NULL)
+        memcpy(payload, it.cur->payload, ptr_list->element_size);
+    return ll_xor_erase(ptr_list, &it);
+}
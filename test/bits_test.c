@@ -0,0 +1,176 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/bits.h>
+#include "test.h"
+
+#define BITS_TEST_OPS                     30000
+
+static uint64_t
+bits_rand(uint64_t *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return *seed;
+}
+
+/* Checks every query against a plain array */
+static int
+bits_matches(ll_bits_t *ptr_bits, const uint16_t *ref, size_t n, unsigned int value)
+{
+    size_t rank = 0;
+    ssize_t next = -1;
+
+    if(ll_bits_len(ptr_bits) != n)
+        return 0;
+    for(size_t i = n; i-- > 0; )
+        if(ref[i] == value)
+            next = i;
+    for(size_t i = 0; i < n; ++i)
+    {
+        if(ll_bits_get(ptr_bits, i) != ref[i])
+            return 0;
+        if(i % 97 == 0)
+        {
+            if(ll_bits_rank(ptr_bits, value, i) != rank)
+                return 0;
+            ssize_t expected = -1;
+            for(size_t j = i; j < n && expected < 0; ++j)
+                if(ref[j] == value)
+                    expected = j;
+            if(ll_bits_search(ptr_bits, value, i) != expected)
+                return 0;
+        }
+        if(ref[i] == value)
+        {
+            if(ll_bits_select(ptr_bits, value, rank) != (ssize_t)i)
+                return 0;
+            ++rank;
+        }
+    }
+    return ll_bits_count(ptr_bits, value) == rank && ll_bits_select(ptr_bits, value, rank) == -1 &&
+           ll_bits_search(ptr_bits, value, 0) == next && ll_bits_get(ptr_bits, n) == -1;
+}
+
+
+void
+test_bits_matches_array()
+{
+    unsigned int widths[] = {1, 3, 5, 8, 13, 16};
+    uint16_t *ref = (uint16_t*)malloc(BITS_TEST_OPS*sizeof(uint16_t));
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+    for(size_t m = 0; m < sizeof(widths)/sizeof(widths[0]); ++m)
+    {
+        ll_bits_t *ptr_bits = ll_bits_new(widths[m]);
+        unsigned int max = (1u << widths[m]) - 1;
+        size_t n = 0, i;
+
+        _assert(ll_bits_insert(ptr_bits, 1, 0) == -1);
+        _assert(ll_bits_del(ptr_bits, 0) == -1);
+        _assert(ll_bits_insert(ptr_bits, 0, max + 1) == -1);
+        for(i = 0; i < BITS_TEST_OPS; ++i)
+        {
+            uint64_t r = bits_rand(&seed);
+            /* Few distinct values, so that searches hit */
+            unsigned int value = (r >> 32) % 4 == 0 ? max : ((r >> 40) % 3) & max;
+            size_t pos = n > 0 ? (r >> 8) % (n + 1) : 0;
+            if(r % 8 < 5 || n == 0)
+            {
+                if(ll_bits_insert(ptr_bits, pos, value) != 0)
+                    break;
+                memmove(ref + pos + 1, ref + pos, (n - pos) * sizeof(uint16_t));
+                ref[pos] = value;
+                ++n;
+            }
+            else if(r % 8 < 7)
+            {
+                pos %= n;
+                if(ll_bits_del(ptr_bits, pos) != 0)
+                    break;
+                memmove(ref + pos, ref + pos + 1, (n - pos - 1) * sizeof(uint16_t));
+                --n;
+            }
+            else
+            {
+                pos %= n;
+                if(ll_bits_set(ptr_bits, pos, value) != 0)
+                    break;
+                ref[pos] = value;
+            }
+        }
+        _assert(i == BITS_TEST_OPS);
+        _assert(bits_matches(ptr_bits, ref, n, max));
+        _assert(bits_matches(ptr_bits, ref, n, 0));
+        ll_bits_destroy(ptr_bits);
+    }
+    _assert(ll_bits_new(0) == NULL);
+    _assert(ll_bits_new(17) == NULL);
+    free(ref);
+}
+
+
+void
+test_bits_drains_and_refills()
+{
+    ll_bits_t *ptr_bits = ll_bits_new(1);
+    size_t i;
+
+    /* Enough flags for several chunks, then deletes from the front merge
+     * and free them */
+    for(i = 0; i < 40000; ++i)
+    {
+        if(ll_bits_insert(ptr_bits, i, i % 3 == 0) != 0)
+            break;
+    }
+    _assert(i == 40000);
+    _assert(ll_bits_count(ptr_bits, 1) == 13334);
+    _assert(ll_bits_select(ptr_bits, 1, 13333) == 39999);
+    _assert(ll_bits_rank(ptr_bits, 0, 40000) == 26666);
+    _assert(ll_bits_rank(ptr_bits, 0, 1000000) == 26666);
+    for(i = 0; i < 39990; ++i)
+    {
+        if(ll_bits_del(ptr_bits, i % 2 ? 0 : ll_bits_len(ptr_bits) - 1) != 0)
+            break;
+    }
+    _assert(i == 39990);
+    _assert(ll_bits_len(ptr_bits) == 10);
+    for(i = 0; i < 10; ++i)
+    {
+        if(ll_bits_get(ptr_bits, i) != ((i + 19995) % 3 == 0))
+            break;
+    }
+    _assert(i == 10);
+    while(ll_bits_len(ptr_bits) > 0 && ll_bits_del(ptr_bits, 0) == 0)
+        ;
+    _assert(ll_bits_len(ptr_bits) == 0);
+    _assert(ll_bits_search(ptr_bits, 0, 0) == -1);
+    _assert(ll_bits_insert(ptr_bits, 0, 1) == 0);
+    _assert(ll_bits_search(ptr_bits, 1, 0) == 0);
+    ll_bits_destroy(ptr_bits);
+}
@@ -0,0 +1,250 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include "test.h"
+
+#define DIFF_MAX 64
+
+typedef struct {
+    uint8_t del[DIFF_MAX];
+    uint8_t ins[DIFF_MAX];
+    size_t last_del;
+    size_t last_ins;
+    int ordered;
+} edits_t;
+
+static ll_t*
+numbers(const uint32_t *data, size_t n, unsigned int flags)
+{
+    ll_t *ptr_list = ll_new(sizeof(uint32_t), flags);
+    for(size_t i = 0; i < n; ++i)
+        ll_insert(ptr_list, (void*)&data[i], i);
+    return ptr_list;
+}
+
+static void
+record(ll_edit_t edit, size_t pos, ll_node_t *ptr_node, void *ctx)
+{
+    edits_t *e = (edits_t*)ctx;
+    (void)ptr_node;
+    if(edit == LL_DIFF_DEL)
+    {
+        e->ordered &= pos + 1 > e->last_del;
+        e->last_del = pos + 1;
+        e->del[pos] = 1;
+    }
+    else
+    {
+        e->ordered &= pos + 1 > e->last_ins;
+        e->last_ins = pos + 1;
+        e->ins[pos] = 1;
+    }
+}
+
+/* Length of the longest common subsequence, by dynamic programming */
+static size_t
+lcs(const uint32_t *a, size_t n, const uint32_t *b, size_t m)
+{
+    static size_t t[DIFF_MAX + 1][DIFF_MAX + 1];
+    for(size_t i = 0; i <= n; ++i)
+        for(size_t j = 0; j <= m; ++j)
+        {
+            if(i == 0 || j == 0)
+                t[i][j] = 0;
+            else if(a[i - 1] == b[j - 1])
+                t[i][j] = t[i - 1][j - 1] + 1;
+            else
+                t[i][j] = t[i - 1][j] > t[i][j - 1] ? t[i - 1][j] : t[i][j - 1];
+        }
+    return t[n][m];
+}
+
+/* Checks that the edits are minimal and that applying them to a gives b */
+static int
+diff_ok(const uint32_t *a, size_t n, const uint32_t *b, size_t m, unsigned int flags)
+{
+    ll_t *ptr_a = numbers(a, n, flags), *ptr_b = numbers(b, m, flags);
+    edits_t e;
+    size_t i = 0;
+
+    memset(&e, 0, sizeof(e));
+    e.ordered = 1;
+    ssize_t edits = ll_diff(ptr_a, ptr_b, record, &e);
+    int ok = edits == (ssize_t)(n + m - 2*lcs(a, n, b, m)) && e.ordered;
+    for(size_t j = 0; ok && j < m; ++j)
+    {
+        if(e.ins[j])
+            continue;
+        while(i < n && e.del[i])
+            ++i;
+        ok = i < n && a[i++] == b[j];
+    }
+    while(i < n && e.del[i])
+        ++i;
+    ok = ok && i == n;
+    ll_destroy(ptr_a);
+    ll_destroy(ptr_b);
+    return ok;
+}
+
+void
+test_equal_and_hash()
+{
+    uint32_t a[] = {1, 2, 3, 4, 5}, b[] = {1, 2, 3, 4, 6};
+    unsigned int modes[] = {0, LL_CIRCULAR, LL_INDEXED, LL_HASHED, LL_HASHED | LL_CIRCULAR};
+
+    for(size_t m = 0; m < 5; ++m)
+    {
+        ll_t *ptr_a = numbers(a, 5, modes[m]);
+        ll_t *ptr_same = numbers(a, 5, 0);
+        ll_t *ptr_b = numbers(b, 5, modes[m]);
+        ll_t *ptr_short = numbers(a, 4, modes[m]);
+
+        _assert(ll_equal(ptr_a, ptr_same));
+        _assert(ll_equal(ptr_same, ptr_a));
+        _assert(!ll_equal(ptr_a, ptr_b));
+        _assert(!ll_equal(ptr_a, ptr_short));
+        _assert(!ll_equal(ptr_short, ptr_a));
+        _assert(ll_hash(ptr_a) == ll_hash(ptr_same));
+        _assert(ll_hash(ptr_a) != ll_hash(ptr_b));
+        _assert(ll_hash(ptr_a) != ll_hash(ptr_short));
+        ll_destroy(ptr_a);
+        ll_destroy(ptr_same);
+        ll_destroy(ptr_b);
+        ll_destroy(ptr_short);
+    }
+
+    /* Same elements in another order */
+    uint32_t c[] = {5, 4, 3, 2, 1};
+    ll_t *ptr_a = numbers(a, 5, LL_HASHED), *ptr_c = numbers(c, 5, LL_HASHED);
+    _assert(!ll_equal(ptr_a, ptr_c));
+    _assert(ll_hash(ptr_a) != ll_hash(ptr_c));
+    ll_destroy(ptr_a);
+    ll_destroy(ptr_c);
+}
+
+void
+test_hash_incremental()
+{
+    ll_t *ptr_hashed = ll_new(sizeof(uint32_t), LL_HASHED);
+    ll_t *ptr_plain = ll_new(sizeof(uint32_t), 0);
+    uint64_t seed = 2463534242ULL;
+
+    for(uint32_t data = 0; data < 300; ++data)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        size_t pos = seed % (data + 1);
+        ll_insert(ptr_hashed, &data, pos);
+        ll_insert(ptr_plain, &data, pos);
+    }
+    for(uint32_t data = 0; data < 300; data += 3)
+    {
+        ll_del(ptr_hashed, &data);
+        ll_del(ptr_plain, &data);
+    }
+    _assert(ll_equal(ptr_hashed, ptr_plain));
+    _assert(ll_hash(ptr_hashed) == ll_hash(ptr_plain));
+
+    /* In place changes are only seen once reported */
+    ll_node_t *ptr_node = ll_node_get(ptr_hashed, 57);
+    *(uint32_t*)ll_node_payload(ptr_node) = 1000;
+    *(uint32_t*)ll_node_payload(ll_node_get(ptr_plain, 57)) = 1000;
+    _assert(ll_hash(ptr_hashed) != ll_hash(ptr_plain));
+    ll_node_changed(ptr_hashed, ptr_node);
+    _assert(ll_hash(ptr_hashed) == ll_hash(ptr_plain));
+
+    ll_destroy(ptr_hashed);
+    ll_destroy(ptr_plain);
+}
+
+void
+test_hash_after_uncircle()
+{
+    uint32_t rotated[] = {2, 3, 4, 0, 1}, other[] = {0, 1, 2, 3, 4};
+    ll_t *ptr_a = numbers(other, 5, LL_HASHED), *ptr_b = numbers(rotated, 5, LL_HASHED);
+
+    /* The cached hash must follow the root moved while circular */
+    ll_set_circular(ptr_a, 1);
+    ll_rotate(ptr_a, 2);
+    ll_set_circular(ptr_a, 0);
+    _assert(ll_equal(ptr_a, ptr_b));
+    _assert(ll_hash(ptr_a) == ll_hash(ptr_b));
+
+    ll_destroy(ptr_b);
+    ptr_b = numbers(other, 5, LL_HASHED);
+    _assert(!ll_equal(ptr_a, ptr_b));
+    _assert(ll_hash(ptr_a) != ll_hash(ptr_b));
+
+    ll_set_circular(ptr_a, 1);
+    ll_rr_next(ptr_a);
+    ll_rr_next(ptr_a);
+    ll_rr_next(ptr_a);
+    ll_set_circular(ptr_a, 0);
+    _assert(ll_equal(ptr_a, ptr_b));
+    _assert(ll_hash(ptr_a) == ll_hash(ptr_b));
+    ll_destroy(ptr_a);
+    ll_destroy(ptr_b);
+}
+
+void
+test_diff_is_shortest()
+{
+    uint32_t a[] = {1, 2, 3, 4, 5, 6, 7}, b[] = {0, 2, 3, 9, 5, 7, 8};
+    uint32_t x[DIFF_MAX], y[DIFF_MAX];
+    uint64_t seed = 88172645463325252ULL;
+    edits_t e;
+    size_t round;
+
+    _assert(diff_ok(a, 7, b, 7, 0));
+    _assert(diff_ok(a, 7, a, 7, 0));
+    _assert(diff_ok(a, 0, b, 7, 0));
+    _assert(diff_ok(a, 7, b, 0, LL_CIRCULAR));
+
+    for(round = 0; round < 500; ++round)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        size_t n = seed % DIFF_MAX, m = (seed >> 8) % DIFF_MAX;
+        /* Few distinct values, so that the lists share long subsequences */
+        for(size_t i = 0; i < n; ++i)
+            x[i] = (seed >> (i % 48)) % 4;
+        for(size_t j = 0; j < m; ++j)
+            y[j] = (seed >> ((j * 7) % 48)) % 4;
+        if(!diff_ok(x, n, y, m, round % 2 ? LL_INDEXED : 0))
+            break;
+    }
+    _assert(round == 500);
+
+    ll_t *ptr_a = numbers(a, 7, 0), *ptr_b = ll_new(sizeof(uint64_t), 0);
+    _assert(ll_diff(ptr_a, ptr_b, record, &e) == -1);
+    _assert(ll_diff(ptr_a, ptr_a, NULL, NULL) == -1);
+    ll_destroy(ptr_a);
+    ll_destroy(ptr_b);
+}
@@ -0,0 +1,233 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <libll/ll.h>
+#include "test.h"
+
+typedef struct {
+    uint32_t id;
+    int16_t delta;
+    double score;
+    char name[12];
+    uint8_t tag[2];
+} record_t;
+
+static const ll_field_t record_fields[] = {
+    {"id", offsetof(record_t, id), LL_FMT_U32, 0},
+    {"delta", offsetof(record_t, delta), LL_FMT_I16, 0},
+    {"score", offsetof(record_t, score), LL_FMT_DOUBLE, 0},
+    {"name", offsetof(record_t, name), LL_FMT_STR, 12},
+    {"tag", offsetof(record_t, tag), LL_FMT_HEX, 2},
+};
+
+static const ll_schema_t record_schema = {record_fields, 5, sizeof(record_t)};
+
+static ll_t*
+build_records()
+{
+    record_t r[3];
+    memset(r, 0, sizeof(r));
+    r[0].id = 1; r[0].delta = -5; r[0].score = 2.5; strcpy(r[0].name, "plain");
+    r[0].tag[0] = 0xab; r[0].tag[1] = 0x01;
+    r[1].id = 2; r[1].delta = 300; r[1].score = -0.125; strcpy(r[1].name, "a,b \"q\"");
+    r[2].id = 4000000000u; r[2].delta = 0; r[2].score = 1e6; strcpy(r[2].name, "tab\tnl\n");
+
+    ll_t *ptr_list = ll_init(&r[0], sizeof(record_t));
+    ptr_list = ll_insert(ptr_list, &r[1], 1);
+    ptr_list = ll_insert(ptr_list, &r[2], 2);
+    return ptr_list;
+}
+
+static char*
+export_to_string(ll_t *ptr_list, ll_format_t format, ssize_t *len)
+{
+    FILE *f = tmpfile();
+    *len = ll_export(ptr_list, &record_schema, format, fileno(f));
+    char *buff = calloc(1, *len > 0 ? *len + 1 : 1);
+    lseek(fileno(f), 0, SEEK_SET);
+    if(*len > 0 && read(fileno(f), buff, *len) != *len)
+        *len = -1;
+    fclose(f);
+    return buff;
+}
+
+static int
+lists_equal(ll_t *a, ll_t *b)
+{
+    ll_node_t *na = a->root, *nb = b->root;
+    while(na != NULL && nb != NULL)
+    {
+        if(memcmp(ll_node_payload(na), ll_node_payload(nb), sizeof(record_t)) != 0)
+            return 0;
+        na = na->next;
+        nb = nb->next;
+    }
+    return na == NULL && nb == NULL;
+}
+
+void
+test_export_csv_writes_header_and_records()
+{
+    ssize_t len;
+    ll_t *ptr_list = build_records();
+    char *csv = export_to_string(ptr_list, LL_CSV, &len);
+    const char *expected =
+        "id,delta,score,name,tag\n"
+        "1,-5,2.500000,plain,ab01\n"
+        "2,300,-0.125000,\"a,b \"\"q\"\"\",0000\n"
+        "4000000000,0,1000000.000000,\"tab\tnl\n\",0000\n";
+    _assert(len == (ssize_t)strlen(expected) && strcmp(csv, expected) == 0);
+    free(csv);
+    ll_destroy(ptr_list);
+}
+
+void
+test_export_csv_full_size_string()
+{
+    ssize_t len;
+    record_t r;
+    memset(&r, 0, sizeof(r));
+    /* No NUL in the name, the comma right after it belongs to the tag */
+    memcpy(r.name, "abcdefghijkl", sizeof(r.name));
+    r.tag[0] = ',';
+    ll_t *ptr_list = ll_init(&r, sizeof(record_t));
+    char *csv = export_to_string(ptr_list, LL_CSV, &len);
+    const char *expected =
+        "id,delta,score,name,tag\n"
+        "0,0,0.000000,abcdefghijkl,2c00\n";
+    _assert(len == (ssize_t)strlen(expected) && strcmp(csv, expected) == 0);
+    free(csv);
+    ll_destroy(ptr_list);
+}
+
+void
+test_export_json_writes_array_of_objects()
+{
+    ssize_t len;
+    ll_t *ptr_list = build_records();
+    char *json = export_to_string(ptr_list, LL_JSON, &len);
+    const char *expected =
+        "[\n"
+        "{\"id\":1,\"delta\":-5,\"score\":2.500000,\"name\":\"plain\",\"tag\":\"ab01\"},\n"
+        "{\"id\":2,\"delta\":300,\"score\":-0.125000,\"name\":\"a,b \\\"q\\\"\",\"tag\":\"0000\"},\n"
+        "{\"id\":4000000000,\"delta\":0,\"score\":1000000.000000,\"name\":\"tab\\u0009nl\\n\",\"tag\":\"0000\"}\n"
+        "]\n";
+    _assert(len == (ssize_t)strlen(expected) && strcmp(json, expected) == 0);
+    free(json);
+    ll_destroy(ptr_list);
+}
+
+void
+test_import_round_trips_export()
+{
+    ll_format_t formats[] = {LL_CSV, LL_JSON};
+    ll_t *ptr_list = build_records();
+
+    for(int i = 0; i < 2; ++i)
+    {
+        FILE *f = tmpfile();
+        _assert(ll_export(ptr_list, &record_schema, formats[i], fileno(f)) > 0);
+        lseek(fileno(f), 0, SEEK_SET);
+        ll_t *imported = ll_import_fd(fileno(f), &record_schema, formats[i]);
+        _assert(imported != NULL && lists_equal(ptr_list, imported));
+        ll_destroy(imported);
+        fclose(f);
+    }
+    ll_destroy(ptr_list);
+}
+
+void
+test_import_feed_handles_split_records()
+{
+    ll_format_t formats[] = {LL_CSV, LL_JSON};
+    ll_t *ptr_list = build_records();
+
+    for(int i = 0; i < 2; ++i)
+    {
+        ssize_t len;
+        char *text = export_to_string(ptr_list, formats[i], &len);
+        ll_import_t *imp = ll_import_begin(&record_schema, formats[i]);
+        int ret = 0;
+        for(ssize_t j = 0; j < len; ++j)
+            ret |= ll_import_feed(imp, text + j, 1);
+        ll_t *imported = ll_import_end(imp);
+        _assert(ret == 0 && imported != NULL && lists_equal(ptr_list, imported));
+        ll_destroy(imported);
+        free(text);
+    }
+    ll_destroy(ptr_list);
+}
+
+static ll_t*
+import_string(const char *text, ll_format_t format)
+{
+    ll_import_t *imp = ll_import_begin(&record_schema, format);
+    ll_import_feed(imp, text, strlen(text));
+    return ll_import_end(imp);
+}
+
+void
+test_import_rejects_malformed_input()
+{
+    _assert(import_string("id,delta\n1,70000\n", LL_CSV) == NULL);
+    _assert(import_string("id,name\n1,\"unterminated\n", LL_CSV) == NULL);
+    _assert(import_string("id\n-1\n", LL_CSV) == NULL);
+    _assert(import_string("[{\"id\":1}", LL_JSON) == NULL);
+    _assert(import_string("[{\"id\":x}]", LL_JSON) == NULL);
+    _assert(import_string("", LL_JSON) == NULL);
+    _assert(ll_import_begin(NULL, LL_CSV) == NULL);
+
+    /* Missing fields are zeroed, unknown ones skipped */
+    ll_t *ptr_list = import_string("extra,id\r\nx,7\r\n\r\ny,8", LL_CSV);
+    _assert(ptr_list != NULL && ll_len(ptr_list) == 2);
+    _assert(((record_t*)ll_node_payload(ptr_list->root))->id == 7);
+    _assert(((record_t*)ll_node_payload(ptr_list->root->next))->id == 8);
+    ll_destroy(ptr_list);
+
+    ptr_list = import_string(" [ ] ", LL_JSON);
+    _assert(ptr_list != NULL && ll_len(ptr_list) == 0);
+    ll_destroy(ptr_list);
+}
+
+void
+test_import_list_supports_insert_and_del()
+{
+    ll_t *ptr_list = import_string("id\n1\n2\n3\n", LL_CSV);
+    record_t r;
+    memset(&r, 0, sizeof(r));
+
+    r.id = 2;
+    ptr_list = ll_del(ptr_list, &r);
+    _assert(ll_len(ptr_list) == 2 && ll_search(ptr_list, &r) == NULL);
+    r.id = 9;
+    ptr_list = ll_insert(ptr_list, &r, 1);
+    _assert(ll_len(ptr_list) == 3);
+    _assert(((record_t*)ll_node_payload(ll_node_get(ptr_list, 1)))->id == 9);
+    _assert(((record_t*)ll_node_payload(ll_node_get(ptr_list, 2)))->id == 3);
+    ll_destroy(ptr_list);
+}
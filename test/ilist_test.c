@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/ilist.h>
+#include "test.h"
+
+/* Checks the list against the expected ranges, given as start, end pairs */
+static int
+ranges_are(ll_ilist_t *ilist, const uint64_t *expected, size_t n)
+{
+    ll_node_t *ptr_node = ll_ilist_list(ilist)->root;
+    if(ll_ilist_len(ilist) != n)
+        return 0;
+    for(size_t i = 0; i < n; ++i, ptr_node = ptr_node->next)
+    {
+        ll_range_t *range = (ll_range_t*)ll_node_payload(ptr_node);
+        if(range->start != expected[2*i] || range->end != expected[2*i + 1])
+            return 0;
+    }
+    return ptr_node == NULL;
+}
+
+void
+test_ilist_coalesces_on_add()
+{
+    ll_ilist_t *ilist = ll_ilist_new();
+
+    _assert(ll_ilist_add(ilist, 10, 20) == 0);
+    _assert(ll_ilist_add(ilist, 30, 40) == 0);
+    _assert(ll_ilist_add(ilist, 50, 60) == 0);
+    _assert(ll_ilist_add(ilist, 5, 5) == -1);
+    uint64_t disjoint[] = {10, 20, 30, 40, 50, 60};
+    _assert(ranges_are(ilist, disjoint, 3));
+
+    /* Touching ranges merge as well as overlapping ones */
+    _assert(ll_ilist_add(ilist, 20, 25) == 0);
+    _assert(ll_ilist_add(ilist, 35, 55) == 0);
+    uint64_t merged[] = {10, 25, 30, 60};
+    _assert(ranges_are(ilist, merged, 2));
+
+    _assert(ll_ilist_add(ilist, 0, 100) == 0);
+    uint64_t all[] = {0, 100};
+    _assert(ranges_are(ilist, all, 1));
+    ll_ilist_destroy(ilist);
+}
+
+void
+test_ilist_splits_on_del()
+{
+    ll_ilist_t *ilist = ll_ilist_new();
+
+    ll_ilist_add(ilist, 0, 100);
+    _assert(ll_ilist_del(ilist, 40, 60) == 0);
+    uint64_t split[] = {0, 40, 60, 100};
+    _assert(ranges_are(ilist, split, 2));
+
+    _assert(ll_ilist_del(ilist, 0, 10) == 0);
+    _assert(ll_ilist_del(ilist, 30, 70) == 0);
+    _assert(ll_ilist_del(ilist, 95, 200) == 0);
+    uint64_t trimmed[] = {10, 30, 70, 95};
+    _assert(ranges_are(ilist, trimmed, 2));
+
+    _assert(ll_ilist_find(ilist, 9) == NULL);
+    _assert(((ll_range_t*)ll_node_payload(ll_ilist_find(ilist, 10)))->end == 30);
+    _assert(ll_ilist_find(ilist, 30) == NULL);
+    _assert(ll_ilist_first(ilist, 30, 70) == NULL);
+    _assert(((ll_range_t*)ll_node_payload(ll_ilist_first(ilist, 30, 71)))->start == 70);
+    _assert(((ll_range_t*)ll_node_payload(ll_ilist_first(ilist, 0, 200)))->start == 10);
+
+    _assert(ll_ilist_del(ilist, 0, 1000) == 0);
+    _assert(ll_ilist_len(ilist) == 0);
+    ll_ilist_destroy(ilist);
+}
+
+void
+test_ilist_matches_bitmap()
+{
+    /* Random adds and deletes, enough to grow several skip levels */
+    ll_ilist_t *ilist = ll_ilist_new();
+    static uint8_t bitmap[20000];
+    uint32_t seed = 2463534242u;
+
+    memset(bitmap, 0, sizeof(bitmap));
+    for(size_t i = 0; i < 20000; ++i)
+    {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        uint64_t start = seed % 19990, end = start + 1 + (seed >> 20) % 8;
+        int add = (seed >> 16) % 3 != 0;
+        if(add)
+            ll_ilist_add(ilist, start, end);
+        else
+            ll_ilist_del(ilist, start, end);
+        memset(&bitmap[start], add, end - start);
+    }
+
+    uint64_t point;
+    for(point = 0; point < 20000; ++point)
+    {
+        if((ll_ilist_find(ilist, point) != NULL) != bitmap[point])
+            break;
+    }
+    _assert(point == 20000);
+
+    /* Ranges must be sorted, disjoint and never touching */
+    size_t n = 0;
+    uint64_t prev_end = 0;
+    ll_node_t *ptr_node;
+    for(ptr_node = ll_ilist_list(ilist)->root; ptr_node != NULL; ptr_node = ptr_node->next, ++n)
+    {
+        ll_range_t *range = (ll_range_t*)ll_node_payload(ptr_node);
+        if(range->start >= range->end || (n > 0 && range->start <= prev_end))
+            break;
+        prev_end = range->end;
+    }
+    _assert(ptr_node == NULL);
+    _assert(n == ll_ilist_len(ilist) && n > 100);
+    ll_ilist_destroy(ilist);
+}
@@ -0,0 +1,147 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <libll/ll.h>
+#include "test.h"
+
+static ll_t*
+build_records(size_t n, size_t size)
+{
+    char record[256];
+    ll_t *ptr_list = NULL;
+    for(size_t i = n; i > 0; --i)
+    {
+        /* Inserting at the head, record i-1 ends up in position i-1 */
+        memset(record, 'a' + (i - 1) % 26, size);
+        if(ptr_list == NULL)
+            ptr_list = ll_init(record, size);
+        else
+            ptr_list = ll_insert(ptr_list, record, 0);
+    }
+    return ptr_list;
+}
+
+static size_t
+read_all(int fd, char *buff, size_t size)
+{
+    size_t len = 0;
+    ssize_t n;
+    while(len < size && (n = read(fd, buff + len, size - len)) > 0)
+        len += n;
+    return len;
+}
+
+void
+test_writev_writes_payloads_and_separators()
+{
+    char buff[64];
+    ll_t *ptr_list = build_records(3, 2);
+    FILE *f = tmpfile();
+
+    _assert(ll_writev(ptr_list, fileno(f), ",", 1) == 8);
+    lseek(fileno(f), 0, SEEK_SET);
+    size_t len = read_all(fileno(f), buff, sizeof(buff));
+    _assert(len == 8 && memcmp(buff, "aa,bb,cc", 8) == 0);
+
+    fclose(f);
+    f = tmpfile();
+    _assert(ll_writev(ptr_list, fileno(f), NULL, 0) == 6);
+    lseek(fileno(f), 0, SEEK_SET);
+    len = read_all(fileno(f), buff, sizeof(buff));
+    _assert(len == 6 && memcmp(buff, "aabbcc", 6) == 0);
+
+    fclose(f);
+    ll_destroy(ptr_list);
+}
+
+void
+test_writev_batches_beyond_iov_max()
+{
+    size_t n = 3000, i;
+    char *buff = malloc(n*2);
+    ll_t *ptr_list = build_records(n, 1);
+    FILE *f = tmpfile();
+
+    _assert(ll_writev(ptr_list, fileno(f), "\n", 1) == (ssize_t)(n*2 - 1));
+    lseek(fileno(f), 0, SEEK_SET);
+    _assert(read_all(fileno(f), buff, n*2) == n*2 - 1);
+    for(i = 0; i < n; ++i)
+    {
+        if(buff[2*i] != (char)('a' + i % 26) || (i < n - 1 && buff[2*i + 1] != '\n'))
+            break;
+    }
+    _assert(i == n);
+
+    fclose(f);
+    free(buff);
+    ll_destroy(ptr_list);
+}
+
+void
+test_writev_resumes_partial_writes()
+{
+    /* Four times the default pipe capacity, drained slowly by a child */
+    size_t n = 2048, size = 128;
+    int fds[2];
+    ll_t *ptr_list = build_records(n, size);
+
+    _assert(pipe(fds) == 0);
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        char *buff = malloc(n*size);
+        close(fds[1]);
+        usleep(10000);
+        size_t len = read_all(fds[0], buff, n*size);
+        for(size_t i = 0; i < len; ++i)
+            if(buff[i] != (char)('a' + (i / size) % 26))
+                _exit(1);
+        _exit(len == n*size ? 0 : 1);
+    }
+    close(fds[0]);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    _assert(ll_writev(ptr_list, fds[1], NULL, 0) == (ssize_t)(n*size));
+    close(fds[1]);
+
+    int status = -1;
+    waitpid(pid, &status, 0);
+    _assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    ll_destroy(ptr_list);
+}
+
+void
+test_writev_nullptr()
+{
+    uint8_t data = 1;
+    ll_t *ptr_list = ll_init(&data, sizeof(uint8_t));
+    _assert(ll_writev(NULL, 1, NULL, 0) == -1);
+    _assert(ll_writev(ptr_list, -1, NULL, 0) == -1);
+    _assert(ll_writev(ptr_list, 1, NULL, 1) == -1);
+    ll_destroy(ptr_list);
+}
@@ -0,0 +1,123 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/lhm.h>
+#include "test.h"
+
+void
+test_lhm_put_get()
+{
+    ll_lhm_t *lhm = ll_lhm_new(sizeof(uint32_t), sizeof(uint64_t));
+    uint32_t key = 7;
+    uint64_t value = 700;
+
+    _assert(ll_lhm_get(lhm, &key) == NULL);
+    _assert(ll_lhm_put(lhm, &key, &value) == 0);
+    _assert(*(uint64_t*)ll_lhm_get(lhm, &key) == 700);
+    value = 701;
+    _assert(ll_lhm_put(lhm, &key, &value) == 0);
+    _assert(ll_lhm_len(lhm) == 1);
+    _assert(*(uint64_t*)ll_lhm_get(lhm, &key) == 701);
+    _assert(ll_lhm_del(lhm, &key) == 0);
+    _assert(ll_lhm_del(lhm, &key) == -1);
+    _assert(ll_lhm_get(lhm, &key) == NULL);
+    _assert(ll_lhm_len(lhm) == 0);
+
+    _assert(ll_lhm_new(0, 8) == NULL);
+    ll_lhm_destroy(lhm);
+}
+
+void
+test_lhm_iterates_in_insertion_order()
+{
+    ll_lhm_t *lhm = ll_lhm_new(sizeof(uint32_t), sizeof(uint32_t));
+    uint32_t keys[] = {42, 7, 19, 3, 88};
+    uint32_t expected[] = {7, 3, 88, 42};
+
+    for(size_t i = 0; i < 5; ++i)
+    {
+        uint32_t value = keys[i] * 2;
+        ll_lhm_put(lhm, &keys[i], &value);
+    }
+    /* Updates keep the position, re-insertions go to the end */
+    uint32_t value = 0;
+    ll_lhm_put(lhm, &keys[1], &value);
+    ll_lhm_del(lhm, &keys[0]);
+    ll_lhm_del(lhm, &keys[2]);
+    ll_lhm_put(lhm, &keys[0], &value);
+
+    size_t n = 0;
+    ll_node_t *ptr_node;
+    for(ptr_node = ll_lhm_list(lhm)->root; ptr_node != NULL && n < 4; ptr_node = ptr_node->next, ++n)
+    {
+        if(*(uint32_t*)ll_node_payload(ptr_node) != expected[n])
+            break;
+        uint32_t v = *(uint32_t*)ll_lhm_value(lhm, ptr_node);
+        if(v != (expected[n] == 7 || expected[n] == 42 ? 0 : expected[n] * 2))
+            break;
+    }
+    _assert(ptr_node == NULL);
+    _assert(n == 4);
+    ll_lhm_destroy(lhm);
+}
+
+void
+test_lhm_incremental_rehash()
+{
+    /* Lookups and deletions run while entries are split across tables */
+    ll_lhm_t *lhm = ll_lhm_new(sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t key;
+
+    for(key = 0; key < 10000; ++key)
+    {
+        uint64_t value = key + 1;
+        if(ll_lhm_put(lhm, &key, &value) != 0)
+            break;
+        if(key % 3 == 0 && ll_lhm_del(lhm, &key) != 0)
+            break;
+        uint64_t probe = key / 2;
+        uint64_t *found = (uint64_t*)ll_lhm_get(lhm, &probe);
+        if(probe % 3 == 0 ? found != NULL : found == NULL || *found != probe + 1)
+            break;
+    }
+    _assert(key == 10000);
+    _assert(ll_lhm_len(lhm) == 6666);
+
+    uint64_t prev = 0;
+    size_t n = 0;
+    ll_node_t *ptr_node;
+    for(ptr_node = ll_lhm_list(lhm)->root; ptr_node != NULL; ptr_node = ptr_node->next, ++n)
+    {
+        key = *(uint64_t*)ll_node_payload(ptr_node);
+        if(key % 3 == 0 || (n > 0 && key <= prev))
+            break;
+        prev = key;
+    }
+    _assert(ptr_node == NULL);
+    _assert(n == 6666);
+    ll_lhm_destroy(lhm);
+}
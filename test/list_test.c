@@ -24,6 +24,8 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
+#include <limits.h>
 #include <libll/ll.h>
 #include "test.h"
 
@@ -194,3 +196,737 @@ test_list_destroy_nullptr() {
     ll_destroy(NULL);
     _assert(1);
 }
+
+/* Builds a circular list of 32 bit integers 0 .. n-1 */
+static ll_t*
+circular_list(uint32_t n)
+{
+    uint32_t data = 0;
+    ll_t *ptr_list = ll_init(&data, sizeof(uint32_t));
+    ll_set_circular(ptr_list, 1);
+    for(data = 1; data < n; ++data)
+        ll_insert(ptr_list, &data, data);
+    return ptr_list;
+}
+
+void
+test_list_circular_traversals_stop()
+{
+    ll_t *ptr_list = circular_list(5);
+    uint32_t data = 3;
+
+    _assert(ptr_list->root->prev->next == ptr_list->root);
+    _assert(ll_len(ptr_list) == 5);
+    _assert(ll_search(ptr_list, &data) != NULL);
+    data = 7;
+    _assert(ll_search(ptr_list, &data) == NULL);
+
+    char *str = ll_print_fmt(ptr_list, LL_FMT_U32);
+    _assert(str != NULL && strcmp(str, "0 1 2 3 4 ") == 0);
+    free(str);
+
+    /* Deleting the root keeps the ring closed */
+    data = 0;
+    ll_del(ptr_list, &data);
+    data = 9;
+    ll_insert(ptr_list, &data, 0);
+    _assert(ll_len(ptr_list) == 5);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 9);
+    _assert(*(uint32_t*)ll_node_payload(ll_node_prev(ptr_list->root)) == 4);
+
+    _assert(ll_set_circular(ptr_list, 0) == 0);
+    _assert(ptr_list->root->prev == NULL && ll_node_get(ptr_list, 4)->next == NULL);
+    ll_destroy(ptr_list);
+
+    /* Destroying a circular list frees every node once */
+    ll_destroy(circular_list(3));
+}
+
+void
+test_list_circular_rotate()
+{
+    ll_t *ptr_list = circular_list(10);
+
+    _assert(ll_rotate(ptr_list, 3) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 3);
+    _assert(ll_rotate(ptr_list, -5) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 8);
+    /* Walks wrapping around the list are reduced modulo its length */
+    _assert(ll_rotate(ptr_list, 1000000004) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 2);
+    _assert(ll_rotate(ptr_list, -29) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 3);
+    _assert(ll_len(ptr_list) == 10);
+
+    /* Rotations close to the length step back instead */
+    _assert(ll_rotate(ptr_list, 9) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 2);
+    _assert(ll_rotate(ptr_list, 11) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 3);
+    _assert(ll_rotate(ptr_list, 10) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 3);
+    _assert(ll_rotate(ptr_list, -9) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 4);
+    _assert(ll_rotate(ptr_list, -10) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 4);
+    _assert(ll_rotate(ptr_list, 6) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 0);
+    /* LONG_MIN, -2^63 or -2^31, is 2 modulo 10 */
+    _assert(ll_rotate(ptr_list, LONG_MIN) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 2);
+    _assert(ll_node_prev(ptr_list->root)->next == ptr_list->root);
+
+    ll_set_circular(ptr_list, 0);
+    _assert(ll_rotate(ptr_list, 1) == -1);
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_circular_round_robin()
+{
+    ll_t *ptr_list = circular_list(3);
+    uint32_t i;
+
+    for(i = 0; i < 10; ++i)
+    {
+        if(*(uint32_t*)ll_node_payload(ll_rr_next(ptr_list)) != i % 3)
+            break;
+    }
+    _assert(i == 10);
+
+    ll_node_t *ptr_node = ptr_list->root;
+    for(uint32_t i = 0; i < 7; ++i)
+        ptr_node = ll_node_next(ptr_node);
+    _assert(ptr_node != NULL && *(uint32_t*)ll_node_payload(ptr_node) == 2);
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_handles_detect_stale_nodes()
+{
+    ll_t *ptr_list = ll_new(sizeof(uint32_t), LL_POOLED);
+    ll_handle_t handles[200];
+    uint32_t i;
+
+    for(uint32_t data = 0; data < 200; ++data)
+        ll_insert(ptr_list, &data, data);
+    for(uint32_t data = 0; data < 200; ++data)
+        handles[data] = ll_handle(ptr_list, ll_search(ptr_list, &data));
+    for(uint32_t data = 0; data < 200; data += 2)
+        ll_del(ptr_list, &data);
+
+    /* Deleted nodes get reused, their old handles must not resolve */
+    for(uint32_t data = 1000; data < 1100; ++data)
+        ll_insert(ptr_list, &data, 0);
+    for(i = 0; i < 200; ++i)
+    {
+        ll_node_t *ptr_node = ll_handle_node(ptr_list, handles[i]);
+        if(i % 2 == 0 ? ptr_node != NULL :
+           ptr_node == NULL || *(uint32_t*)ll_node_payload(ptr_node) != i)
+            break;
+    }
+    _assert(i == 200);
+
+    ll_handle_t bogus = {100000, 1};
+    _assert(ll_handle_node(ptr_list, bogus) == NULL);
+    ll_destroy(ptr_list);
+
+    /* Lists allocating nodes one by one have no handles */
+    uint32_t data = 1;
+    ptr_list = ll_init(&data, sizeof(uint32_t));
+    _assert(ll_handle_node(ptr_list, ll_handle(ptr_list, ptr_list->root)) == NULL);
+    ll_destroy(ptr_list);
+}
+
+/* Checks ll_index_of against the position found by walking the list */
+static int
+index_of_matches_walk(ll_t *ptr_list)
+{
+    size_t len = ll_len(ptr_list), pos = 0;
+    for(ll_node_t *ptr_node = ptr_list->root; pos < len; ptr_node = ptr_node->next, ++pos)
+    {
+        if(ll_index_of(ptr_list, ptr_node) != (ssize_t)pos)
+            return 0;
+    }
+    return 1;
+}
+
+void
+test_list_index_of_indexed()
+{
+    ll_t *ptr_list = ll_new(sizeof(uint32_t), LL_INDEXED);
+    uint32_t seed = 2463534242u;
+
+    for(uint32_t data = 0; data < 3000; ++data)
+    {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        ll_insert(ptr_list, &data, seed % (ll_len(ptr_list) + 1));
+        if(data % 4 == 3)
+        {
+            uint32_t victim = seed % data;
+            ll_del(ptr_list, &victim);
+        }
+    }
+    _assert(index_of_matches_walk(ptr_list));
+
+    /* Positions are relative to the root after rotations */
+    ll_set_circular(ptr_list, 1);
+    ll_rotate(ptr_list, 1234);
+    ll_rr_next(ptr_list);
+    uint32_t data = 5000;
+    ll_insert(ptr_list, &data, 0);
+    _assert(ll_index_of(ptr_list, ptr_list->root) == 0);
+    _assert(index_of_matches_walk(ptr_list));
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_index_of_after_uncircle()
+{
+    uint32_t data = 0;
+    ll_t *ptr_list = ll_new(sizeof(uint32_t), LL_INDEXED);
+
+    for(data = 0; data < 5; ++data)
+        ll_insert(ptr_list, &data, data);
+    ll_set_circular(ptr_list, 1);
+    ll_rotate(ptr_list, 2);
+    ll_set_circular(ptr_list, 0);
+
+    /* The list reads 2 3 4 0 1 and the index must follow the new root */
+    _assert(*(uint32_t*)ll_node_payload(ptr_list->root) == 2);
+    _assert(ll_index_of(ptr_list, ptr_list->root) == 0);
+    _assert(ll_node_get(ptr_list, 0) == ptr_list->root);
+    _assert(*(uint32_t*)ll_node_payload(ll_node_get(ptr_list, 3)) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ll_node_get(ptr_list, 4)) == 1);
+    _assert(index_of_matches_walk(ptr_list));
+
+    /* Round-robin moves the root the same way */
+    ll_set_circular(ptr_list, 1);
+    ll_rr_next(ptr_list);
+    ll_set_circular(ptr_list, 0);
+    data = 9;
+    ll_insert(ptr_list, &data, 0);
+    ll_insert(ptr_list, &data, ll_len(ptr_list));
+    _assert(*(uint32_t*)ll_node_payload(ll_node_get(ptr_list, 1)) == 3);
+    _assert(*(uint32_t*)ll_node_payload(ll_node_get(ptr_list, 5)) == 2);
+    _assert(index_of_matches_walk(ptr_list));
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_index_of_walks_back()
+{
+    ll_t *ptr_list = ll_new(sizeof(uint32_t), 0);
+
+    for(uint32_t data = 0; data < 100; ++data)
+        ll_insert(ptr_list, &data, data);
+    /* Increasing queries reuse the previous answer */
+    _assert(index_of_matches_walk(ptr_list));
+    uint32_t data = 10;
+    ll_del(ptr_list, &data);
+    _assert(ll_index_of(ptr_list, ll_node_get(ptr_list, 50)) == 50);
+    _assert(ll_index_of(ptr_list, ll_node_get(ptr_list, 20)) == 20);
+    _assert(ll_index_of(ptr_list, ll_node_get(ptr_list, 98)) == 98);
+    _assert(ll_index_of(ptr_list, NULL) == -1);
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_variable_insert_search()
+{
+    const char *words[] = {"a", "linked", "list", "of", "words"};
+    ll_t *ptr_list = ll_new(0, LL_VARIABLE);
+    size_t i;
+
+    for(i = 0; i < 5; ++i)
+    {
+        if(ll_insert_var(ptr_list, words[i], strlen(words[i]), i) != ptr_list)
+            break;
+    }
+    _assert(i == 5);
+    _assert(ll_insert_var(ptr_list, NULL, 0, 2) == ptr_list);
+    _assert(ll_len(ptr_list) == 6);
+    _assert(ll_node_size(ptr_list, ll_node_get(ptr_list, 1)) == 6);
+    _assert(memcmp(ll_node_payload(ll_node_get(ptr_list, 1)), "linked", 6) == 0);
+    _assert(ll_node_size(ptr_list, ll_node_get(ptr_list, 2)) == 0);
+
+    /* Prefixes of a payload do not match it */
+    _assert(ll_search_var(ptr_list, "list", 4) == ll_node_get(ptr_list, 3));
+    _assert(ll_search_var(ptr_list, "lis", 3) == NULL);
+    _assert(ll_search_var(ptr_list, NULL, 0) == ll_node_get(ptr_list, 2));
+
+    /* Fixed size lists and variable lists holding the same payloads */
+    ll_t *ptr_fixed = ll_new(2, 0);
+    ll_t *ptr_var = ll_new(2, LL_VARIABLE);
+    ll_insert(ptr_fixed, "of", 0);
+    ll_insert(ptr_var, "of", 0);
+    _assert(ll_equal(ptr_fixed, ptr_var));
+    _assert(ll_hash(ptr_fixed) == ll_hash(ptr_var));
+    _assert(ll_search(ptr_var, "of") != NULL);
+    ll_insert_var(ptr_var, "off", 3, 1);
+    _assert(!ll_equal(ptr_fixed, ptr_var));
+    _assert(ll_hash(ptr_fixed) != ll_hash(ptr_var));
+    ll_del(ptr_var, "of");
+    _assert(ll_len(ptr_var) == 1);
+    _assert(ll_node_size(ptr_var, ptr_var->root) == 3);
+
+    _assert(ll_insert_var(ptr_fixed, "off", 3, 0) == NULL);
+    _assert(ll_new(8, LL_VARIABLE | LL_POOLED) == NULL);
+    _assert(ll_new(8, LL_VARIABLE | LL_INDEXED) == NULL);
+    ll_destroy(ptr_fixed);
+    ll_destroy(ptr_var);
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_variable_print_writev()
+{
+    ll_t *ptr_list = ll_new(0, LL_VARIABLE | LL_CIRCULAR);
+    uint32_t number = 7;
+    char buff[64];
+    int fds[2];
+
+    ll_insert_var(ptr_list, "abc", 3, 0);
+    ll_insert_var(ptr_list, "\x01\x02", 2, 1);
+    ll_insert_var(ptr_list, "", 0, 2);
+
+    char *str = ll_print_fmt(ptr_list, LL_FMT_HEX);
+    _assert(str != NULL && strcmp(str, "616263 0102  ") == 0);
+    free(str);
+    str = ll_print_fmt_mt(ptr_list, LL_FMT_STR, 2);
+    _assert(str != NULL && strcmp(str, "abc \x01\x02  ") == 0);
+    free(str);
+    /* The two byte payload is narrower than a 32 bit integer */
+    _assert(ll_print_fmt(ptr_list, LL_FMT_U32) == NULL);
+
+    _assert(pipe(fds) == 0);
+    _assert(ll_writev(ptr_list, fds[1], ",", 1) == 7);
+    _assert(read(fds[0], buff, sizeof(buff)) == 7);
+    _assert(memcmp(buff, "abc,\x01\x02,", 7) == 0);
+    close(fds[0]);
+    close(fds[1]);
+
+    ll_destroy(ptr_list);
+    ptr_list = ll_new(0, LL_VARIABLE);
+    ll_insert_var(ptr_list, &number, sizeof(number), 0);
+    str = ll_print_fmt(ptr_list, LL_FMT_U32);
+    _assert(str != NULL && strcmp(str, "7 ") == 0);
+    free(str);
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_small_payloads()
+{
+    /* Sizes on both sides of the threshold for inline payloads */
+    size_t sizes[] = {1, 8, 16, 17, 64};
+    char buff[64];
+
+    for(size_t i = 0; i < 5; ++i)
+    {
+        memset(buff, 'a', sizeof(buff));
+        ll_t *ptr_list = ll_init(buff, sizes[i]);
+        for(char c = 'b'; c < 'z'; ++c)
+        {
+            memset(buff, c, sizeof(buff));
+            ll_insert(ptr_list, buff, ll_len(ptr_list));
+        }
+        memset(buff, 'k', sizeof(buff));
+        ll_del(ptr_list, buff);
+        _assert(ll_len(ptr_list) == 24);
+        _assert(ll_search(ptr_list, buff) == NULL);
+        char *payload = (char*)ll_node_payload(ll_node_get(ptr_list, 10));
+        _assert(payload[0] == 'l');
+        _assert(payload[sizes[i] - 1] == 'l');
+        ll_destroy(ptr_list);
+    }
+}
+
+void
+test_list_hotcold_search()
+{
+    ll_t *ptr_list = ll_new(3*sizeof(uint64_t), LL_HOTCOLD);
+    uint64_t record[3] = {0, 0, 0};
+
+    _assert(ptr_list != NULL);
+
+    for(uint64_t i = 0; i < 1000; ++i)
+    {
+        record[2] = i;
+        ll_insert(ptr_list, record, 0);
+    }
+    record[2] = 400;
+    ll_node_t *ptr_node = ll_search(ptr_list, record);
+    _assert(ptr_node != NULL && ll_index_of(ptr_list, ptr_node) == 599);
+    ll_handle_t handle = ll_handle(ptr_list, ptr_node);
+
+    /* In place changes are only seen once reported */
+    ((uint64_t*)ll_node_payload(ptr_node))[2] = 5000;
+    _assert(ll_search(ptr_list, record) == NULL);
+    record[2] = 5000;
+    _assert(ll_search(ptr_list, record) == NULL);
+    ll_node_changed(ptr_list, ptr_node);
+    _assert(ll_search(ptr_list, record) == ptr_node);
+
+    ll_del(ptr_list, record);
+    _assert(ll_len(ptr_list) == 999);
+    _assert(ll_handle_node(ptr_list, handle) == NULL);
+    record[2] = 1001;
+    ll_insert(ptr_list, record, 999);
+    _assert(ll_search(ptr_list, record) == ll_node_get(ptr_list, 999));
+
+    /* Neither prefixes nor longer keys match a fixed size payload */
+    uint64_t longer[4] = {0, 0, 1001, 0};
+    _assert(ll_search_var(ptr_list, record, 2*sizeof(uint64_t)) == NULL);
+    _assert(ll_search_var(ptr_list, longer, sizeof(longer)) == NULL);
+    _assert(ll_search_var(ptr_list, record, sizeof(record)) == ll_node_get(ptr_list, 999));
+
+    _assert(ll_new(8, LL_HOTCOLD | LL_INDEXED) == NULL);
+    _assert(ll_new(8, LL_HOTCOLD | LL_VARIABLE) == NULL);
+    ll_destroy(ptr_list);
+}
+
+void
+test_list_aligned_payloads()
+{
+    unsigned int modes[] = {0, 0, LL_POOLED, LL_INDEXED, LL_HOTCOLD, LL_VARIABLE};
+    size_t sizes[] = {8, 40, 40, 8, 100, 0};
+    char record[100];
+
+    for(size_t m = 0; m < 6; ++m)
+    {
+        ll_t *ptr_list = ll_new_aligned(sizes[m], modes[m], LL_CACHELINE);
+        for(size_t i = 0; i < 300; ++i)
+        {
+            memset(record, (int)i, sizeof(record));
+            if(modes[m] & LL_VARIABLE)
+                ll_insert_var(ptr_list, record, i % 100, 0);
+            else
+                ll_insert(ptr_list, record, 0);
+        }
+        size_t pos = 0;
+        ll_node_t *ptr_node;
+        for(ptr_node = ptr_list->root; ptr_node != NULL; ptr_node = ptr_node->next, ++pos)
+        {
+            uintptr_t payload = (uintptr_t)ll_node_payload(ptr_node);
+            /* Nodes are never in the cache line of the payload */
+            if(payload % LL_CACHELINE != 0 || (uintptr_t)ptr_node / LL_CACHELINE == payload / LL_CACHELINE)
+                break;
+            if(ll_node_size(ptr_list, ptr_node) != 0 &&
+               *(unsigned char*)payload != (unsigned char)(299 - pos))
+                break;
+        }
+        _assert(ptr_node == NULL);
+        _assert(pos == 300);
+        if(modes[m] & LL_INDEXED)
+            _assert(ll_index_of(ptr_list, ll_node_get(ptr_list, 123)) == 123);
+        /* On the variable size list this deletes an empty payload */
+        memset(record, 10, sizeof(record));
+        ll_del(ptr_list, record);
+        _assert(ll_len(ptr_list) == 299);
+        ll_destroy(ptr_list);
+    }
+    _assert(ll_new_aligned(8, 0, 24) == NULL);
+}
+
+void
+test_list_hugepage_slabs()
+{
+    unsigned int modes[] = {LL_POOLED, LL_INDEXED | LL_HUGEPAGES, LL_HOTCOLD | LL_HUGEPAGES};
+    ll_stats_t stats;
+
+    for(size_t m = 0; m < 3; ++m)
+    {
+        ll_t *ptr_list = ll_new(sizeof(uint64_t), modes[m]);
+        for(uint64_t data = 0; data < 20000; ++data)
+            ll_insert(ptr_list, &data, data % 2 ? 0 : data);
+        uint64_t data = 17;
+        ll_del(ptr_list, &data);
+        _assert(ll_stats(ptr_list, &stats) == 0);
+        _assert(stats.objects == ((modes[m] & LL_HOTCOLD) ? 2*19999 : 19999));
+        _assert(stats.slabs > 0);
+        if(modes[m] & LL_HUGEPAGES)
+        {
+            /* Whether huge pages are available depends on the system */
+            _assert(stats.bytes == stats.slabs << 21);
+            _assert(stats.hugetlb_slabs + stats.thp_slabs <= stats.slabs);
+        }
+        else
+        {
+            _assert(stats.hugetlb_slabs == 0);
+            _assert(stats.thp_slabs == 0);
+        }
+        ll_node_t *ptr_node = ll_search(ptr_list, &data);
+        data = 18;
+        _assert(ptr_node == NULL);
+        _assert(ll_search(ptr_list, &data) != NULL);
+        ll_destroy(ptr_list);
+    }
+
+    ll_t *ptr_list = ll_new(sizeof(uint64_t), 0);
+    _assert(ll_stats(ptr_list, &stats) == 0);
+    _assert(stats.slabs == 0);
+    _assert(stats.bytes == 0);
+    _assert(ll_stats(NULL, &stats) == -1);
+    ll_destroy(ptr_list);
+}
+
+
+void
+test_list_numa_placement()
+{
+    unsigned int modes[] = {LL_NUMA, LL_NUMA | LL_INDEXED, LL_NUMA | LL_HOTCOLD | LL_HUGEPAGES};
+
+    for(size_t m = 0; m < 3; ++m)
+    {
+        ll_t *ptr_list = ll_new(sizeof(uint64_t), modes[m]);
+        _assert(ptr_list != NULL && (ptr_list->flags & LL_POOLED));
+        _assert(ll_numa_set_node(ptr_list, 0) == 0);
+        for(uint64_t data = 0; data < 5000; ++data)
+            ll_insert(ptr_list, &data, 0);
+        ll_node_t *ptr_node = ll_node_get(ptr_list, 100);
+        ll_handle_t handle = ll_handle(ptr_list, ptr_node);
+
+        /* Node 0 always exists, the syscall may be unavailable though */
+        _assert(ll_numa_migrate(ptr_list, 0) == 0);
+        int node = ll_numa_node_of(ptr_node);
+        _assert(node == 0 || node == -1);
+        _assert(ll_handle_node(ptr_list, handle) == ptr_node);
+        _assert(ll_index_of(ptr_list, ptr_node) == 100);
+        _assert(*(uint64_t*)ll_node_payload(ptr_node) == 4899);
+
+        /* Slots freed before the migration are reused on the new node
+         * rather than growing the list, even with no preferred node */
+        ll_stats_t before, after;
+        for(uint64_t data = 0; data < 1000; ++data)
+            ll_del(ptr_list, &data);
+        ll_stats(ptr_list, &before);
+        _assert(ll_numa_migrate(ptr_list, 0) == 0);
+        _assert(ll_numa_set_node(ptr_list, -1) == 0);
+        for(uint64_t data = 0; data < 1000; ++data)
+            ll_insert(ptr_list, &data, 0);
+        ll_stats(ptr_list, &after);
+        _assert(after.slabs == before.slabs);
+        node = ll_numa_node_of(ptr_list->root);
+        _assert(node == 0 || node == -1);
+
+        _assert(ll_numa_set_node(ptr_list, 1000) == -1);
+        _assert(ll_numa_migrate(ptr_list, -2) == -1);
+        _assert(ll_numa_set_node(ptr_list, -1) == 0);
+        uint64_t data = 4899;
+        ll_del(ptr_list, &data);
+        _assert(ll_len(ptr_list) == 4999);
+        _assert(ll_handle_node(ptr_list, handle) == NULL);
+        ll_destroy(ptr_list);
+    }
+
+    ll_t *ptr_list = ll_new(sizeof(uint64_t), LL_POOLED);
+    _assert(ll_numa_set_node(ptr_list, 0) == -1);
+    _assert(ll_numa_migrate(ptr_list, 0) == -1);
+    ll_destroy(ptr_list);
+}
+
+
+void
+test_list_strings_interned()
+{
+    const char *words[] = {"to", "be", "or", "not", "to", "be", ""};
+    ll_t *ptr_plain = ll_new(0, LL_STRING);
+    ll_t *ptr_a = ll_new(0, LL_STRING);
+    ll_t *ptr_b = ll_new(0, LL_STRING | LL_CIRCULAR);
+    ll_strtab_t *ptr_strtab = ll_strtab_new();
+
+    size_t i;
+
+    _assert(ptr_plain->flags & LL_VARIABLE);
+    _assert(ll_set_strtab(ptr_plain, NULL) == -1);
+    _assert(ll_set_strtab(ptr_a, ptr_strtab) == 0);
+    _assert(ll_set_strtab(ptr_b, ptr_strtab) == 0);
+    _assert(ll_set_strtab(ptr_a, ptr_strtab) == -1);
+    for(i = 0; i < 7; ++i)
+    {
+        if(ll_insert_str(ptr_plain, words[i], i) != ptr_plain || ll_insert_str(ptr_a, words[i], i) != ptr_a)
+            break;
+    }
+    _assert(i == 7);
+    _assert(ll_insert_str(ptr_b, "be", 0) == ptr_b);
+    _assert(ll_insert_str(ptr_b, "question", 1) == ptr_b);
+
+    /* Payloads are NUL terminated, their size is the length of the string */
+    ll_node_t *ptr_node = ll_search_str(ptr_plain, "not");
+    _assert(ptr_node == ll_node_get(ptr_plain, 3));
+    _assert(ll_node_size(ptr_plain, ptr_node) == 3);
+    _assert(strcmp((char*)ll_node_payload(ptr_node), "not") == 0);
+    _assert(ll_search_str(ptr_plain, "no") == NULL);
+    _assert(ll_search_str(ptr_plain, "") == ll_node_get(ptr_plain, 6));
+    _assert(ll_search_var(ptr_plain, "or", 2) == ll_node_get(ptr_plain, 2));
+
+    /* Changes in place are picked up once reported */
+    memcpy(ll_node_payload(ptr_node), "now", 3);
+    ll_node_changed(ptr_plain, ptr_node);
+    _assert(ll_search_str(ptr_plain, "now") == ptr_node);
+    _assert(ll_search_str(ptr_plain, "not") == NULL);
+
+    /* Equal strings share storage, within a list and across lists */
+    _assert(ll_strtab_len(ptr_strtab) == 6);
+    _assert(ll_node_payload(ll_node_get(ptr_a, 1)) == ll_node_payload(ll_node_get(ptr_a, 5)));
+    _assert(ll_node_payload(ll_search_str(ptr_b, "be")) == ll_node_payload(ll_node_get(ptr_a, 1)));
+    _assert(ll_search_str(ptr_a, "be") == ll_node_get(ptr_a, 1));
+    _assert(ll_search_str(ptr_a, "question") == NULL);
+    _assert(ll_search_str(ptr_a, "whether") == NULL);
+    _assert(ll_node_size(ptr_a, ll_node_get(ptr_a, 3)) == 3);
+    _assert(strcmp((char*)ll_node_payload(ll_node_get(ptr_a, 3)), "not") == 0);
+
+    ll_t *ptr_words = ll_new(0, LL_STRING);
+    for(i = 0; i < 7; ++i)
+        ll_insert_str(ptr_words, words[i], i);
+    _assert(ll_equal(ptr_a, ptr_words));
+    _assert(ll_hash(ptr_a) == ll_hash(ptr_words));
+    ll_destroy(ptr_words);
+
+    /* Strings go away with the last node using them */
+    ll_destroy(ptr_a);
+    _assert(ll_strtab_len(ptr_strtab) == 2);
+    ll_strtab_destroy(ptr_strtab);
+    _assert(ll_search_str(ptr_b, "question") == ll_node_get(ptr_b, 1));
+
+    _assert(ll_insert_str(ptr_b, NULL, 0) == NULL);
+    _assert(ll_search_str(ptr_b, NULL) == NULL);
+    ll_t *ptr_bytes = ll_new(0, LL_VARIABLE);
+    _assert(ll_insert_str(ptr_bytes, "be", 0) == NULL);
+    _assert(ll_set_strtab(ptr_bytes, ptr_strtab) == -1);
+    ll_destroy(ptr_bytes);
+    ll_destroy(ptr_b);
+    ll_destroy(ptr_plain);
+}
+
+
+typedef struct {
+    uint64_t id;
+    char body[200];
+} shared_record_t;
+
+void
+test_list_shared_payloads()
+{
+    ll_t *ptr_a = ll_new(sizeof(shared_record_t), LL_SHARED);
+    ll_t *ptr_b = ll_new(sizeof(shared_record_t), LL_SHARED | LL_CIRCULAR);
+    ll_t *ptr_c = ll_new_aligned(sizeof(shared_record_t), LL_SHARED, LL_CACHELINE);
+    shared_record_t record;
+
+    size_t pos;
+
+    memset(&record, 0, sizeof(record));
+    for(record.id = 0; record.id < 8; ++record.id)
+    {
+        if(ll_insert(ptr_a, &record, record.id) != ptr_a)
+            break;
+    }
+    _assert(record.id == 8);
+    /* Inserting a payload held elsewhere only takes a reference */
+    for(pos = 0; pos < 8; pos += 2)
+    {
+        void *payload = ll_node_payload(ll_node_get(ptr_a, pos));
+        if(ll_insert_shared(ptr_b, payload, ll_len(ptr_b)) != ptr_b ||
+           ll_node_payload(ll_node_get(ptr_b, pos / 2)) != payload)
+            break;
+    }
+    _assert(pos == 8);
+    _assert(ll_insert_shared(ptr_b, ll_node_payload(ll_node_get(ptr_b, 0)), 0) == ptr_b);
+    _assert(ll_payload_refs(ptr_a, ll_node_get(ptr_a, 0)) == 3);
+    _assert(ll_payload_refs(ptr_a, ll_node_get(ptr_a, 1)) == 1);
+    _assert(ll_payload_refs(ptr_b, ll_node_get(ptr_b, 3)) == 2);
+    record.id = 4;
+    _assert(ll_search(ptr_b, &record) == ll_node_get(ptr_b, 3));
+
+    /* Writes copy the payload when other nodes hold it */
+    ll_node_t *ptr_node = ll_node_get(ptr_b, 3);
+    shared_record_t *ptr_record = (shared_record_t*)ll_node_payload_mut(ptr_b, ptr_node);
+    _assert(ptr_record != NULL);
+    _assert(ptr_record != ll_node_payload(ll_node_get(ptr_a, 4)));
+    ptr_record->id = 40;
+    _assert(((shared_record_t*)ll_node_payload(ll_node_get(ptr_a, 4)))->id == 4);
+    _assert(ll_payload_refs(ptr_b, ptr_node) == 1);
+    _assert(ll_payload_refs(ptr_a, ll_node_get(ptr_a, 4)) == 1);
+    _assert(ll_node_payload_mut(ptr_b, ptr_node) == (void*)ptr_record);
+
+    /* Payloads outlive the list which created them */
+    void *payload = ll_node_payload(ll_node_get(ptr_a, 6));
+    ll_destroy(ptr_a);
+    _assert(((shared_record_t*)ll_node_payload(ll_node_get(ptr_b, 4)))->id == 6);
+    _assert(ll_payload_refs(ptr_b, ll_node_get(ptr_b, 4)) == 1);
+    _assert(ll_node_payload(ll_node_get(ptr_b, 4)) == payload);
+    record.id = 0;
+    ll_del(ptr_b, &record);
+    _assert(ll_payload_refs(ptr_b, ptr_b->root) == 1);
+    _assert(ll_len(ptr_b) == 4);
+
+    record.id = 9;
+    _assert(ll_insert(ptr_c, &record, 0) == ptr_c);
+    _assert(((uintptr_t)ll_node_payload(ptr_c->root) % LL_CACHELINE) == 0);
+    _assert(ll_insert_shared(ptr_c, NULL, 0) == NULL);
+    ll_t *ptr_plain = ll_new(sizeof(shared_record_t), 0);
+    ll_insert(ptr_plain, &record, 0);
+    _assert(ll_insert_shared(ptr_plain, ll_node_payload(ptr_c->root), 0) == NULL);
+    _assert(ll_payload_refs(ptr_plain, ptr_plain->root) == 1);
+    _assert(ll_node_payload_mut(ptr_plain, ptr_plain->root) == ll_node_payload(ptr_plain->root));
+    _assert(ll_new(8, LL_SHARED | LL_POOLED) == NULL);
+    _assert(ll_new(8, LL_SHARED | LL_VARIABLE) == NULL);
+    ll_destroy(ptr_plain);
+    ll_destroy(ptr_c);
+    ll_destroy(ptr_b);
+}
+
+
+void
+test_list_lazy_delete()
+{
+    ll_t *ptr_list = ll_new(sizeof(uint64_t), LL_LAZY | LL_INDEXED);
+    ll_handle_t handles[1000];
+
+    for(uint64_t data = 0; data < 1000; ++data)
+    {
+        ll_insert(ptr_list, &data, data);
+        handles[data] = ll_handle(ptr_list, ll_node_get(ptr_list, data));
+    }
+    uint64_t data;
+    for(data = 0; data < 1000; data += 2)
+    {
+        if(ll_del_handle(ptr_list, handles[data]) != 0)
+            break;
+        /* Tombstones are out of the list and their handles stale at once */
+        if(ll_del_handle(ptr_list, handles[data]) != -1 || ll_handle_node(ptr_list, handles[data]) != NULL)
+            break;
+    }
+    _assert(data == 1000);
+    /* Compaction kicked in once tombstones reached a quarter of the list */
+    _assert(ptr_list->ntombs > 0);
+    _assert(ptr_list->ntombs < 500);
+    _assert(ll_len(ptr_list) == 500);
+    _assert(*(uint64_t*)ll_node_payload(ll_node_get(ptr_list, 10)) == 21);
+    data = 2;
+    _assert(ll_search(ptr_list, &data) == NULL);
+    data = 3;
+    _assert(ll_index_of(ptr_list, ll_search(ptr_list, &data)) == 1);
+    _assert(ll_handle_node(ptr_list, handles[999]) == ll_node_get(ptr_list, 499));
+    size_t ntombs = ptr_list->ntombs;
+    _assert(ll_compact(ptr_list) == ntombs);
+    _assert(ptr_list->ntombs == 0);
+    _assert(ll_compact(ptr_list) == 0);
+    ll_destroy(ptr_list);
+
+    /* Unpooled lists free tombstones left over on destroy */
+    ptr_list = ll_new(sizeof(uint32_t), LL_LAZY | LL_CIRCULAR);
+    for(uint32_t value = 0; value < 6; ++value)
+        ll_insert(ptr_list, &value, value);
+    uint32_t value = 0;
+    ll_del(ptr_list, &value);
+    value = 4;
+    ll_del(ptr_list, &value);
+    _assert(ll_del_node(ptr_list, ll_node_get(ptr_list, 1)) == 0);
+    char *str = ll_print_fmt(ptr_list, LL_FMT_U32);
+    _assert(str != NULL && strcmp(str, "1 3 5 ") == 0);
+    _assert(ptr_list->ntombs == 3);
+    free(str);
+    ll_destroy(ptr_list);
+}
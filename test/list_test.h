@@ -35,5 +35,22 @@ void test_list_del_nullptr();
 void test_list_search_nullptr();
 void test_list_print_nullptr();
 void test_list_destroy_nullptr();
+void test_list_circular_traversals_stop();
+void test_list_circular_rotate();
+void test_list_circular_round_robin();
+void test_list_handles_detect_stale_nodes();
+void test_list_index_of_indexed();
+void test_list_index_of_after_uncircle();
+void test_list_index_of_walks_back();
+void test_list_variable_insert_search();
+void test_list_variable_print_writev();
+void test_list_small_payloads();
+void test_list_hotcold_search();
+void test_list_aligned_payloads();
+void test_list_hugepage_slabs();
+void test_list_numa_placement();
+void test_list_strings_interned();
+void test_list_shared_payloads();
+void test_list_lazy_delete();
 
 #endif
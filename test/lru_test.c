@@ -0,0 +1,168 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/lru.h>
+#include "test.h"
+
+static void
+record_evict(void *key, void *value, void *ctx)
+{
+    uint32_t *evicted = (uint32_t*)ctx;
+    evicted[evicted[0]++ + 1] = *(uint32_t*)key;
+}
+
+void
+test_lru_put_get()
+{
+    ll_lru_t *lru = ll_lru_new(sizeof(uint32_t), sizeof(uint64_t), 4, NULL, NULL);
+    uint32_t key = 7;
+    uint64_t value = 700;
+
+    _assert(ll_lru_get(lru, &key) == NULL);
+    _assert(ll_lru_put(lru, &key, &value) == 0);
+    _assert(ll_lru_len(lru) == 1);
+    _assert(*(uint64_t*)ll_lru_get(lru, &key) == 700);
+
+    value = 701;
+    _assert(ll_lru_put(lru, &key, &value) == 0);
+    _assert(ll_lru_len(lru) == 1);
+    _assert(*(uint64_t*)ll_lru_get(lru, &key) == 701);
+
+    /* Keys wider than a word go through the generic hash */
+    ll_lru_t *wide = ll_lru_new(20, sizeof(uint64_t), 4, NULL, NULL);
+    char wide_key[20] = "a key of 20 bytes..";
+    _assert(ll_lru_put(wide, wide_key, &value) == 0);
+    _assert(*(uint64_t*)ll_lru_get(wide, wide_key) == 701);
+    wide_key[19] = '!';
+    _assert(ll_lru_get(wide, wide_key) == NULL);
+    ll_lru_destroy(wide);
+
+    _assert(ll_lru_new(0, 8, 4, NULL, NULL) == NULL);
+    _assert(ll_lru_new(4, 8, 0, NULL, NULL) == NULL);
+    ll_lru_destroy(lru);
+}
+
+void
+test_lru_evicts_least_recently_used()
+{
+    uint32_t evicted[16] = {0};
+    ll_lru_t *lru = ll_lru_new(sizeof(uint32_t), sizeof(uint32_t), 3, record_evict, evicted);
+
+    for(uint32_t key = 1; key <= 3; ++key)
+        ll_lru_put(lru, &key, &key);
+
+    /* 1 becomes the most recently used, 2 the least */
+    uint32_t key = 1;
+    ll_lru_get(lru, &key);
+    key = 2;
+    ll_node_t *ptr_lru = ll_lru_node(lru, &key);
+    key = 4;
+    ll_lru_put(lru, &key, &key);
+    _assert(evicted[0] == 1 && evicted[1] == 2);
+    /* A full cache puts new entries in the node it evicts */
+    _assert(ll_lru_node(lru, &key) == ptr_lru);
+    _assert(*(uint32_t*)ll_lru_get(lru, &key) == 4);
+
+    key = 3;
+    ll_lru_touch(lru, ll_lru_node(lru, &key));
+    key = 5;
+    ll_lru_put(lru, &key, &key);
+    _assert(evicted[0] == 2 && evicted[2] == 1);
+    _assert(ll_lru_len(lru) == 3);
+
+    /* Most recently used first: 5 3 4 */
+    ll_node_t *ptr_node = ll_lru_list(lru)->root;
+    _assert(*(uint32_t*)ll_node_payload(ptr_node) == 5);
+    _assert(*(uint32_t*)ll_node_payload(ptr_node->next) == 3);
+    _assert(*(uint32_t*)ll_node_payload(ptr_node->next->next) == 4);
+    ll_lru_destroy(lru);
+}
+
+void
+test_lru_del_keeps_index_consistent()
+{
+    /* Many colliding probes, checked against a plain array */
+    size_t capacity = 500, universe = 2000, i;
+    uint8_t present[2000] = {0};
+    ll_lru_t *lru = ll_lru_new(sizeof(uint32_t), sizeof(uint32_t), capacity, NULL, NULL);
+    uint32_t seed = 12345;
+
+    for(i = 0; i < 20000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t key = (seed >> 8) % universe;
+        if((seed >> 4) % 3 == 0)
+        {
+            if((ll_lru_del(lru, &key) == 0) != present[key])
+                break;
+            present[key] = 0;
+        }
+        else if(ll_lru_len(lru) < capacity || present[key])
+        {
+            ll_lru_put(lru, &key, &key);
+            present[key] = 1;
+        }
+    }
+    _assert(i == 20000);
+    uint32_t key;
+    for(key = 0; key < universe; ++key)
+    {
+        uint32_t *value = (uint32_t*)ll_lru_get(lru, &key);
+        if((value != NULL) != present[key] || (value != NULL && *value != key))
+            break;
+    }
+    _assert(key == universe);
+    ll_lru_destroy(lru);
+}
+
+void
+test_lru_get_batch()
+{
+    ll_lru_t *lru = ll_lru_new(sizeof(uint32_t), sizeof(uint32_t), 64, NULL, NULL);
+    uint32_t keys[40];
+    void *values[40];
+
+    for(uint32_t key = 0; key < 64; key += 2)
+    {
+        uint32_t value = key * 10;
+        ll_lru_put(lru, &key, &value);
+    }
+    for(uint32_t i = 0; i < 40; ++i)
+        keys[i] = i;
+
+    _assert(ll_lru_get_batch(lru, keys, 40, values) == 20);
+    uint32_t i;
+    for(i = 0; i < 40; ++i)
+    {
+        if(i % 2 == 0 ? values[i] == NULL || *(uint32_t*)values[i] != i*10 : values[i] != NULL)
+            break;
+    }
+    _assert(i == 40);
+    /* The last hit of the batch is the most recently used */
+    _assert(*(uint32_t*)ll_node_payload(ll_lru_list(lru)->root) == 38);
+    ll_lru_destroy(lru);
+}
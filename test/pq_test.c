@@ -0,0 +1,179 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/pq.h>
+#include "test.h"
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Pops everything and returns the number of entries, 0 if they came out
+ * of order */
+static size_t
+drain_sorted(ll_pq_t *pq)
+{
+    uint32_t prev = 0, value;
+    size_t n = 0;
+    int sorted = 1;
+    while(ll_pq_pop(pq, &value) == 0)
+    {
+        if(n > 0 && prev > value)
+            sorted = 0;
+        prev = value;
+        ++n;
+    }
+    return sorted ? n : 0;
+}
+
+void
+test_pq_pops_in_order()
+{
+    ll_pq_t *pq = ll_pq_new(sizeof(uint32_t), cmp_u32);
+    uint32_t seed = 2463534242u, value;
+    size_t i;
+
+    _assert(ll_pq_pop(pq, &value) == -1);
+    _assert(ll_pq_peek(pq) == NULL);
+    for(i = 0; i < 2000; ++i)
+    {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        value = seed % 500;
+        if(ll_pq_push(pq, &value) == NULL)
+            break;
+        /* Interleave pops so that the heap is restructured often */
+        if(i % 3 == 2 && ll_pq_pop(pq, NULL) != 0)
+            break;
+    }
+    _assert(i == 2000);
+    _assert(ll_pq_len(pq) == 1334);
+    _assert(drain_sorted(pq) == 1334);
+    _assert(ll_pq_len(pq) == 0);
+
+    _assert(ll_pq_new(0, cmp_u32) == NULL);
+    _assert(ll_pq_new(4, NULL) == NULL);
+    ll_pq_destroy(pq);
+}
+
+void
+test_pq_decrease_and_del()
+{
+    ll_pq_t *pq = ll_pq_new(sizeof(uint32_t), cmp_u32);
+    ll_node_t *handles[100];
+
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        uint32_t value = 1000 + i;
+        handles[i] = ll_pq_push(pq, &value);
+    }
+    /* Restructure so that handles sit deep in the heap */
+    ll_pq_del(pq, handles[0]);
+    uint32_t value = 5;
+    _assert(ll_pq_decrease(pq, handles[70], &value) == 0);
+    _assert(*(uint32_t*)ll_node_payload(ll_pq_peek(pq)) == 5);
+    value = 6;
+    _assert(ll_pq_decrease(pq, handles[70], &value) == -1);
+
+    uint32_t i;
+    for(i = 1; i < 100; i += 2)
+    {
+        if(ll_pq_del(pq, handles[i]) != 0)
+            break;
+    }
+    _assert(i == 101);
+    value = 1;
+    _assert(ll_pq_decrease(pq, handles[98], &value) == 0);
+    _assert(ll_pq_len(pq) == 49);
+
+    ll_pq_pop(pq, &value);
+    _assert(value == 1);
+    ll_pq_pop(pq, &value);
+    _assert(value == 5);
+    _assert(drain_sorted(pq) == 47);
+    ll_pq_destroy(pq);
+}
+
+void
+test_pq_meld()
+{
+    ll_pq_t *a = ll_pq_new(sizeof(uint32_t), cmp_u32);
+    ll_pq_t *b = ll_pq_new(sizeof(uint32_t), cmp_u32);
+    ll_pq_t *c = ll_pq_new(sizeof(uint64_t), cmp_u32);
+    ll_node_t *handle = NULL;
+
+    for(uint32_t i = 0; i < 300; ++i)
+    {
+        uint32_t value = i * 2 + 1;
+        ll_pq_push(a, &value);
+        value = i * 2;
+        handle = ll_pq_push(b, &value);
+    }
+    _assert(ll_pq_meld(a, c) == -1);
+    _assert(ll_pq_meld(a, b) == 0);
+    _assert(ll_pq_len(a) == 600);
+
+    /* Handles of the melded queue stay usable */
+    uint32_t value = 0;
+    _assert(ll_pq_decrease(a, handle, &value) == 0);
+    _assert(drain_sorted(a) == 600);
+    value = 9;
+    _assert(ll_pq_push(a, &value) != NULL);
+    ll_pq_destroy(a);
+    ll_pq_destroy(c);
+
+    /* Free entries of the melded queue get reused */
+    ll_node_t *freed[300];
+    a = ll_pq_new(sizeof(uint32_t), cmp_u32);
+    b = ll_pq_new(sizeof(uint32_t), cmp_u32);
+    for(uint32_t i = 0; i < 300; ++i)
+    {
+        ll_pq_push(a, &i);
+        freed[i] = ll_pq_push(b, &i);
+    }
+    for(uint32_t i = 0; i < 100; ++i)
+        ll_pq_pop(b, NULL);
+    _assert(ll_pq_meld(a, b) == 0);
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        ll_node_t *ptr_node = ll_pq_push(a, &i);
+        size_t j = 0;
+        while(j < 100 && freed[j] != ptr_node)
+            ++j;
+        if(j == 100)
+        {
+            _assert(0);
+            ll_pq_destroy(a);
+            return;
+        }
+    }
+    _assert(1);
+    _assert(drain_sorted(a) == 600);
+    ll_pq_destroy(a);
+}
@@ -0,0 +1,172 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <libll/ll.h>
+#include "test.h"
+
+
+void
+test_print_fmt_integers_match_sprintf()
+{
+    int64_t values[] = {0, 7, -7, 42, 99, 100, -128, 127, 65535, -32768,
+                        1234567890, -2147483648LL, INT64_MAX, INT64_MIN};
+    size_t i, n = sizeof(values)/sizeof(values[0]);
+    char expected[1024];
+    size_t len = 0;
+
+    ll_t *ptr_list = ll_init(&values[0], sizeof(int64_t));
+    for(i = 1; i < n; ++i)
+        ptr_list = ll_insert(ptr_list, &values[i], i);
+    for(i = 0; i < n; ++i)
+        len += snprintf(expected + len, sizeof(expected) - len, "%" PRId64 " ", values[i]);
+
+    char *repr = ll_print_fmt(ptr_list, LL_FMT_I64);
+    _assert(repr != NULL && strcmp(repr, expected) == 0);
+    free(repr);
+
+    len = 0;
+    for(i = 0; i < n; ++i)
+        len += snprintf(expected + len, sizeof(expected) - len, "%" PRIu64 " ", (uint64_t)values[i]);
+    repr = ll_print_fmt(ptr_list, LL_FMT_U64);
+    _assert(repr != NULL && strcmp(repr, expected) == 0);
+    free(repr);
+
+    len = 0;
+    for(i = 0; i < n; ++i)
+        len += snprintf(expected + len, sizeof(expected) - len, "%d ", (int16_t)values[i]);
+    repr = ll_print_fmt(ptr_list, LL_FMT_I16);
+    _assert(repr != NULL && strcmp(repr, expected) == 0);
+    free(repr);
+
+    len = 0;
+    for(i = 0; i < n; ++i)
+        len += snprintf(expected + len, sizeof(expected) - len, "%u ", (uint8_t)values[i]);
+    repr = ll_print_fmt(ptr_list, LL_FMT_U8);
+    _assert(repr != NULL && strcmp(repr, expected) == 0);
+    free(repr);
+
+    ll_destroy(ptr_list);
+}
+
+
+void
+test_print_fmt_doubles_match_sprintf()
+{
+    double values[] = {0.0, -0.0, 1.5, -2.25, 3.1415926535, 0.0000005, 0.0000015,
+                       999999.9999996, 1e300, -1e-9, 123456789.125};
+    size_t i, n = sizeof(values)/sizeof(values[0]);
+    char expected[2048];
+    size_t len = 0;
+
+    ll_t *ptr_list = ll_init(&values[0], sizeof(double));
+    for(i = 1; i < n; ++i)
+        ptr_list = ll_insert(ptr_list, &values[i], i);
+    for(i = 0; i < n; ++i)
+        len += snprintf(expected + len, sizeof(expected) - len, "%f ", values[i]);
+
+    char *repr = ll_print_fmt(ptr_list, LL_FMT_DOUBLE);
+    _assert(repr != NULL && strcmp(repr, expected) == 0);
+    free(repr);
+    ll_destroy(ptr_list);
+
+    float f = 0.1f;
+    ptr_list = ll_init(&f, sizeof(float));
+    snprintf(expected, sizeof(expected), "%f ", f);
+    repr = ll_print_fmt(ptr_list, LL_FMT_FLOAT);
+    _assert(repr != NULL && strcmp(repr, expected) == 0);
+    free(repr);
+    ll_destroy(ptr_list);
+}
+
+
+void
+test_print_fmt_hex_and_str()
+{
+    char a[8] = "abc", b[8] = "defghijk";
+
+    ll_t *ptr_list = ll_init(a, sizeof(a));
+    ptr_list = ll_insert(ptr_list, b, 1);
+
+    char *repr = ll_print_fmt(ptr_list, LL_FMT_STR);
+    _assert(repr != NULL && strcmp(repr, "abc defghijk ") == 0);
+    free(repr);
+
+    repr = ll_print_fmt(ptr_list, LL_FMT_HEX);
+    _assert(repr != NULL && strcmp(repr, "6162630000000000 6465666768696a6b ") == 0);
+    free(repr);
+    ll_destroy(ptr_list);
+}
+
+
+void
+test_print_fmt_rejects_narrow_payload()
+{
+    uint16_t data = 1;
+    ll_t *ptr_list = ll_init(&data, sizeof(uint16_t));
+    _assert(ll_print_fmt(ptr_list, LL_FMT_U32) == NULL);
+    _assert(ll_print_fmt(ptr_list, LL_FMT_DOUBLE) == NULL);
+    _assert(ll_print_fmt(NULL, LL_FMT_U8) == NULL);
+    ll_destroy(ptr_list);
+}
+
+
+int
+print_int32_payload(void *ptr, char *str)
+{
+    return sprintf(str, "%d ", *((int32_t*)ptr));
+}
+
+void
+test_print_mt_matches_sequential()
+{
+    int32_t data = 0;
+    unsigned int threads[] = {1, 2, 3, 7, 0};
+    size_t i, n = 5000;
+
+    ll_t *ptr_list = ll_init(&data, sizeof(int32_t));
+    for(i = 1; i < n; ++i)
+    {
+        data = (int32_t)(i * 2654435761u);
+        ptr_list = ll_insert(ptr_list, &data, 0);
+    }
+
+    char *expected = ll_print(ptr_list, print_int32_payload);
+    for(i = 0; i < sizeof(threads)/sizeof(threads[0]); ++i)
+    {
+        char *repr = ll_print_mt(ptr_list, print_int32_payload, threads[i]);
+        _assert(repr != NULL && strcmp(repr, expected) == 0);
+        free(repr);
+        repr = ll_print_fmt_mt(ptr_list, LL_FMT_I32, threads[i]);
+        _assert(repr != NULL && strcmp(repr, expected) == 0);
+        free(repr);
+    }
+    free(expected);
+
+    _assert(ll_print_mt(NULL, print_int32_payload, 2) == NULL);
+    _assert(ll_print_mt(ptr_list, NULL, 2) == NULL);
+    ll_destroy(ptr_list);
+}
@@ -0,0 +1,130 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include "test.h"
+
+static uint64_t
+xorshift(void *ctx)
+{
+    uint64_t *s = (uint64_t*)ctx;
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+static ll_t*
+numbers(uint32_t n, unsigned int flags)
+{
+    ll_t *ptr_list = ll_new(sizeof(uint32_t), flags);
+    for(uint32_t data = 0; data < n; ++data)
+        ll_insert(ptr_list, &data, data);
+    return ptr_list;
+}
+
+/* Samples k out of 10 elements many times, checking hit counts */
+static int
+sample_counts_ok(ll_t *ptr_list, size_t k)
+{
+    uint64_t seed = 88172645463325252ULL;
+    size_t counts[10] = {0};
+    ll_node_t *nodes[10];
+
+    for(size_t round = 0; round < 20000; ++round)
+    {
+        uint32_t seen = 0;
+        if(ll_sample(ptr_list, nodes, k, xorshift, &seed) != k)
+            return 0;
+        for(size_t i = 0; i < k; ++i)
+        {
+            uint32_t v = *(uint32_t*)ll_node_payload(nodes[i]);
+            if(seen & (1u << v))
+                return 0;
+            seen |= 1u << v;
+            ++counts[v];
+        }
+    }
+    /* Each element is expected 20000*k/10 times */
+    for(size_t v = 0; v < 10; ++v)
+    {
+        if(counts[v] <= 1800*k || counts[v] >= 2200*k)
+            return 0;
+    }
+    return 1;
+}
+
+void
+test_sample_is_uniform()
+{
+    ll_t *ptr_list = numbers(10, 0);
+    ll_node_t *nodes[20];
+
+    _assert(sample_counts_ok(ptr_list, 3));
+    _assert(ll_sample(ptr_list, nodes, 20, NULL, NULL) == 10);
+    _assert(ll_sample(NULL, nodes, 2, NULL, NULL) == 0);
+    ll_destroy(ptr_list);
+}
+
+void
+test_sample_indexed_list()
+{
+    /* k*k <= n takes the O(k log n) path */
+    ll_t *ptr_list = numbers(10, LL_INDEXED);
+    _assert(sample_counts_ok(ptr_list, 3));
+    _assert(sample_counts_ok(ptr_list, 8));
+    ll_destroy(ptr_list);
+}
+
+void
+test_shuffle_keeps_elements()
+{
+    unsigned int modes[] = {0, LL_CIRCULAR, LL_INDEXED, LL_INDEXED | LL_CIRCULAR};
+    uint64_t seed = 12345;
+
+    for(size_t m = 0; m < 4; ++m)
+    {
+        ll_t *ptr_list = numbers(500, modes[m]);
+        uint8_t seen[500] = {0};
+        size_t moved = 0, n = 0;
+
+        _assert(ll_shuffle(ptr_list, xorshift, &seed) == 0);
+        _assert(ll_len(ptr_list) == 500);
+        for(ll_node_t *ptr_node = ptr_list->root; n < 500; ptr_node = ptr_node->next, ++n)
+        {
+            uint32_t v = *(uint32_t*)ll_node_payload(ptr_node);
+            if(v >= 500 || seen[v] || ll_index_of(ptr_list, ptr_node) != (ssize_t)n)
+                break;
+            if(ptr_node->next != NULL && ptr_node->next->prev != ptr_node)
+                break;
+            seen[v] = 1;
+            moved += v != n;
+        }
+        _assert(n == 500);
+        _assert(moved > 400);
+        ll_destroy(ptr_list);
+    }
+}
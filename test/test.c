@@ -21,6 +21,18 @@
  */
 
 #include "list_test.h"
+#include "print_test.h"
+#include "io_test.h"
+#include "export_test.h"
+#include "lru_test.h"
+#include "lhm_test.h"
+#include "wheel_test.h"
+#include "pq_test.h"
+#include "ilist_test.h"
+#include "sample_test.h"
+#include "diff_test.h"
+#include "xor_test.h"
+#include "bits_test.h"
 
 int main()
 {
@@ -37,6 +49,79 @@ int main()
     test_list_search_nullptr();
     test_list_print_nullptr();
     test_list_destroy_nullptr();
+    test_list_circular_traversals_stop();
+    test_list_circular_rotate();
+    test_list_circular_round_robin();
+    test_list_handles_detect_stale_nodes();
+    test_list_index_of_indexed();
+    test_list_index_of_after_uncircle();
+    test_list_index_of_walks_back();
+    test_list_variable_insert_search();
+    test_list_variable_print_writev();
+    test_list_small_payloads();
+    test_list_hotcold_search();
+    test_list_aligned_payloads();
+    test_list_hugepage_slabs();
+    test_list_numa_placement();
+    test_list_strings_interned();
+    test_list_shared_payloads();
+    test_list_lazy_delete();
+
+    test_print_fmt_integers_match_sprintf();
+    test_print_fmt_doubles_match_sprintf();
+    test_print_fmt_hex_and_str();
+    test_print_fmt_rejects_narrow_payload();
+    test_print_mt_matches_sequential();
+
+    test_writev_writes_payloads_and_separators();
+    test_writev_batches_beyond_iov_max();
+    test_writev_resumes_partial_writes();
+    test_writev_nullptr();
+
+    test_export_csv_writes_header_and_records();
+    test_export_csv_full_size_string();
+    test_export_json_writes_array_of_objects();
+    test_import_round_trips_export();
+    test_import_feed_handles_split_records();
+    test_import_rejects_malformed_input();
+    test_import_list_supports_insert_and_del();
+
+    test_lru_put_get();
+    test_lru_evicts_least_recently_used();
+    test_lru_del_keeps_index_consistent();
+    test_lru_get_batch();
+
+    test_lhm_put_get();
+    test_lhm_iterates_in_insertion_order();
+    test_lhm_incremental_rehash();
+
+    test_wheel_fires_on_time();
+    test_wheel_cancel();
+    test_wheel_callback_may_cancel_and_schedule();
+
+    test_pq_pops_in_order();
+    test_pq_decrease_and_del();
+    test_pq_meld();
+
+    test_ilist_coalesces_on_add();
+    test_ilist_splits_on_del();
+    test_ilist_matches_bitmap();
+
+    test_sample_is_uniform();
+    test_sample_indexed_list();
+    test_shuffle_keeps_elements();
+
+    test_equal_and_hash();
+    test_hash_incremental();
+    test_hash_after_uncircle();
+    test_diff_is_shortest();
+
+    test_xor_push_pop_both_ends();
+    test_xor_insert_erase_at_iterator();
+    test_xor_node_size();
+
+    test_bits_matches_array();
+    test_bits_drains_and_refills();
     return 0;
 
 }
@@ -0,0 +1,154 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/wheel.h>
+#include "test.h"
+
+typedef struct {
+    uint64_t lo, hi;
+    size_t fired;
+    size_t errors;
+    ll_wheel_t *wheel;
+    ll_node_t *victim;
+} wheel_ctx_t;
+
+static void
+check_window(void *data, void *ctx)
+{
+    wheel_ctx_t *c = (wheel_ctx_t*)ctx;
+    uint64_t expires = *(uint64_t*)data;
+    if(expires < c->lo || expires > c->hi)
+        ++c->errors;
+    ++c->fired;
+}
+
+void
+test_wheel_fires_on_time()
+{
+    /* One timer per level, plus boundaries between levels */
+    uint64_t start = 1000;
+    uint64_t expires[] = {0, 1000, 1001, 1255, 1256, 1300, 66535, 66536,
+                          70000, 1000 + (1 << 24) + 5};
+    size_t n = sizeof(expires)/sizeof(expires[0]);
+    ll_wheel_t *wheel = ll_wheel_new(sizeof(uint64_t), start);
+    wheel_ctx_t ctx = {0, 0, 0, 0, NULL, NULL};
+
+    for(size_t i = 0; i < n; ++i)
+        _assert(ll_wheel_schedule(wheel, expires[i], &expires[i]) != NULL);
+    _assert(ll_wheel_len(wheel) == n);
+
+    /* Overdue timers fire right away */
+    ctx.hi = start;
+    _assert(ll_wheel_advance(wheel, start, check_window, &ctx) == 2);
+
+    for(uint64_t now = start + 7; ctx.lo <= expires[n-1]; now += 7)
+    {
+        ctx.lo = ctx.hi + 1;
+        ctx.hi = now;
+        ll_wheel_advance(wheel, now, check_window, &ctx);
+    }
+    _assert(ctx.errors == 0);
+    _assert(ctx.fired == n);
+    _assert(ll_wheel_len(wheel) == 0);
+
+    /* There is no tick after UINT64_MAX to move to */
+    _assert(ll_wheel_schedule(wheel, UINT64_MAX - 1, &expires[0]) != NULL);
+    _assert(ll_wheel_advance(wheel, UINT64_MAX, NULL, NULL) == 0);
+    ll_wheel_destroy(wheel);
+}
+
+void
+test_wheel_cancel()
+{
+    ll_wheel_t *wheel = ll_wheel_new(sizeof(uint64_t), 0);
+    ll_node_t *timers[1000];
+    wheel_ctx_t ctx = {0, 100000, 0, 0, NULL, NULL};
+    uint64_t i;
+
+    for(i = 0; i < 1000; ++i)
+    {
+        uint64_t expires = (i * 7919) % 100000;
+        timers[i] = ll_wheel_schedule(wheel, expires, &expires);
+        if(timers[i] == NULL || *(uint64_t*)ll_node_payload(timers[i]) != expires)
+            break;
+    }
+    _assert(i == 1000);
+    for(i = 0; i < 1000; i += 2)
+    {
+        if(ll_wheel_cancel(wheel, timers[i]) != 0)
+            break;
+    }
+    _assert(i == 1000);
+    _assert(ll_wheel_len(wheel) == 500);
+
+    _assert(ll_wheel_advance(wheel, 100000, check_window, &ctx) == 500);
+    _assert(ctx.errors == 0);
+    _assert(ctx.fired == 500);
+    _assert(ll_wheel_len(wheel) == 0);
+    ll_wheel_destroy(wheel);
+}
+
+static void
+cancel_sibling(void *data, void *ctx)
+{
+    wheel_ctx_t *c = (wheel_ctx_t*)ctx;
+    ++c->fired;
+    if(c->victim != NULL)
+    {
+        /* Data holds the index of the sibling to cancel */
+        ll_node_t **timers = (ll_node_t**)c->victim;
+        if(ll_wheel_cancel(c->wheel, timers[*(uint64_t*)data]) != 0)
+            ++c->errors;
+        c->victim = NULL;
+        uint64_t again = 50;
+        if(ll_wheel_schedule(c->wheel, again, &again) == NULL)
+            ++c->errors;
+    }
+}
+
+void
+test_wheel_callback_may_cancel_and_schedule()
+{
+    ll_wheel_t *wheel = ll_wheel_new(sizeof(uint64_t), 0);
+    ll_node_t *timers[2];
+    wheel_ctx_t ctx = {0, 0, 0, 0, wheel, (ll_node_t*)timers};
+
+    /* Both timers share a slot, whichever fires first cancels the other
+     * while it is still waiting in the spliced out slot */
+    for(uint64_t i = 0; i < 2; ++i)
+    {
+        uint64_t sibling = 1 - i;
+        timers[i] = ll_wheel_schedule(wheel, 10, &sibling);
+    }
+    _assert(ll_wheel_advance(wheel, 20, cancel_sibling, &ctx) == 1);
+    _assert(ctx.errors == 0);
+    _assert(ctx.fired == 1);
+    _assert(ll_wheel_len(wheel) == 1);
+    _assert(ll_wheel_advance(wheel, 60, cancel_sibling, &ctx) == 1);
+    _assert(ll_wheel_len(wheel) == 0);
+    ll_wheel_destroy(wheel);
+}
@@ -0,0 +1,190 @@
+/*
+ * The MIT License (MIT)
+ * Copyright (C) 2016 Marco Guerri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <libll/ll.h>
+#include <libll/xor.h>
+#include "test.h"
+
+#define XOR_TEST_OPS                      20000
+#define XOR_TEST_CAP                      (2*XOR_TEST_OPS + 1)
+
+/* Checks the list against the window [lo, hi) of a reference array, walking
+ * it forward from the front and backward from the back */
+static int
+xor_matches(ll_xor_t *ptr_list, const uint64_t *ref, size_t lo, size_t hi)
+{
+    size_t i = lo;
+    if(ll_xor_len(ptr_list) != hi - lo)
+        return 0;
+    for(ll_xor_iter_t it = ll_xor_begin(ptr_list); it.cur != NULL; it = ll_xor_next(it))
+    {
+        if(i >= hi || *(uint64_t*)ll_xor_payload(it) != ref[i++])
+            return 0;
+    }
+    if(i != hi)
+        return 0;
+    for(ll_xor_iter_t it = ll_xor_end(ptr_list); it.prev != NULL; )
+    {
+        it = ll_xor_prev(it);
+        if(i <= lo || *(uint64_t*)ll_xor_payload(it) != ref[--i])
+            return 0;
+    }
+    return i == lo;
+}
+
+
+void
+test_xor_push_pop_both_ends()
+{
+    uint64_t *ref = (uint64_t*)malloc(XOR_TEST_CAP*sizeof(uint64_t));
+    size_t lo = XOR_TEST_OPS, hi = XOR_TEST_OPS, i;
+    uint64_t seed = 0x2545f4914f6cdd1dULL, data;
+    ll_xor_t *ptr_list = ll_xor_new(sizeof(uint64_t));
+
+    _assert(ll_xor_pop_front(ptr_list, &data) == -1);
+    _assert(ll_xor_pop_back(ptr_list, &data) == -1);
+    for(i = 0; i < XOR_TEST_OPS; ++i)
+    {
+        int done;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        switch(seed % 5)
+        {
+            case 0:
+                done = ll_xor_push_front(ptr_list, &seed) == 0;
+                ref[--lo] = seed;
+                break;
+            case 1:
+            case 2:
+                done = ll_xor_push_back(ptr_list, &seed) == 0;
+                ref[hi++] = seed;
+                break;
+            case 3:
+                if(lo == hi)
+                    done = ll_xor_pop_front(ptr_list, &data) == -1;
+                else
+                    done = ll_xor_pop_front(ptr_list, &data) == 0 && data == ref[lo++];
+                break;
+            default:
+                if(lo == hi)
+                    done = ll_xor_pop_back(ptr_list, NULL) == -1;
+                else
+                    done = ll_xor_pop_back(ptr_list, NULL) == 0 && --hi >= lo;
+        }
+        if(!done || (i % 4000 == 0 && !xor_matches(ptr_list, ref, lo, hi)))
+            break;
+    }
+    _assert(i == XOR_TEST_OPS);
+    _assert(xor_matches(ptr_list, ref, lo, hi));
+    while(ll_xor_pop_back(ptr_list, &data) == 0)
+    {
+        if(hi == lo || data != ref[hi - 1])
+            break;
+        --hi;
+    }
+    _assert(lo == hi);
+    _assert(ll_xor_len(ptr_list) == 0);
+    _assert(ll_xor_begin(ptr_list).cur == NULL);
+    _assert(ll_xor_end(ptr_list).prev == NULL);
+
+    ll_xor_destroy(ptr_list);
+    free(ref);
+}
+
+
+void
+test_xor_insert_erase_at_iterator()
+{
+    uint64_t ref[64];
+    size_t n = 0;
+    ll_xor_t *ptr_list = ll_xor_new(sizeof(uint64_t));
+    ll_xor_iter_t it;
+
+    /* Evens pushed at the back, then odds inserted before their successor */
+    for(uint64_t data = 0; data < 64; data += 2)
+        ll_xor_push_back(ptr_list, &data);
+    for(it = ll_xor_begin(ptr_list); it.cur != NULL; it = ll_xor_next(it))
+    {
+        uint64_t data = *(uint64_t*)ll_xor_payload(it) + 1;
+        it = ll_xor_next(it);
+        if(ll_xor_insert(ptr_list, &it, &data) != 0 || *(uint64_t*)ll_xor_payload(it) != data)
+            break;
+    }
+    _assert(it.cur == NULL);
+    for(n = 0; n < 64; ++n)
+        ref[n] = n;
+    _assert(xor_matches(ptr_list, ref, 0, 64));
+
+    /* Erasing moves the iterator forward, drop every multiple of 3 */
+    n = 0;
+    for(it = ll_xor_begin(ptr_list); it.cur != NULL; )
+    {
+        uint64_t data = *(uint64_t*)ll_xor_payload(it);
+        if(data % 3 != 0)
+        {
+            ref[n++] = data;
+            it = ll_xor_next(it);
+        }
+        else if(ll_xor_erase(ptr_list, &it) != 0)
+            break;
+    }
+    _assert(xor_matches(ptr_list, ref, 0, n));
+
+    uint64_t data = 31;
+    it = ll_xor_search(ptr_list, &data);
+    _assert(it.cur != NULL && *(uint64_t*)ll_xor_payload(it) == 31);
+    it = ll_xor_prev(it);
+    _assert(*(uint64_t*)ll_xor_payload(it) == 29);
+    data = 30;
+    _assert(ll_xor_search(ptr_list, &data).cur == NULL);
+    _assert(ll_xor_erase(ptr_list, &it) == 0);
+    _assert(ll_xor_erase(ptr_list, &(ll_xor_iter_t){ll_xor_end(ptr_list).prev, NULL}) == -1);
+
+    ll_stats_t stats;
+    memset(&stats, 0xab, sizeof(stats));
+    _assert(ll_xor_stats(ptr_list, &stats) == 0);
+    _assert(stats.objects == n - 1);
+    ll_xor_destroy(ptr_list);
+}
+
+
+void
+test_xor_node_size()
+{
+    ll_xor_t *ptr_list = ll_xor_new(sizeof(uint64_t));
+    ll_stats_t stats;
+
+    _assert(ll_xor_new(0) == NULL);
+
+    /* Nodes of 8 byte payloads take two words, slab headers aside */
+    for(uint64_t data = 0; data < 4096; ++data)
+        ll_xor_push_back(ptr_list, &data);
+    _assert(ll_xor_stats(ptr_list, &stats) == 0);
+    _assert(stats.objects == 4096);
+    _assert(stats.bytes < 4096*2*sizeof(uint64_t) + 4096);
+    ll_xor_destroy(ptr_list);
+}